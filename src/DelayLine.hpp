@@ -0,0 +1,265 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+/*
+ * Storage policies for the delay line of the FIR filters.
+ *
+ * All of them keep the last N samples and index them oldest first,
+ * they only differ in how a new sample gets in:
+ *
+ * MirroredDelayLine  every sample is written twice, the window is always
+ *                    contiguous. 2N samples of memory, one compare per push.
+ * MaskedDelayLine    ring padded to a power of two, the position wraps with
+ *                    a mask instead of a modulo or a branch. The window wraps
+ *                    around, so it can't be handed to the vector kernels.
+ * ShiftDelayLine     the samples are moved by one per push, like a shift
+ *                    register. N samples of memory and a contiguous window,
+ *                    only cheap for tiny N.
+ *
+ * DynamicMirroredDelayLine is a MirroredDelayLine with N chosen at runtime,
+ * it is no policy, DynamicFilter uses it directly.
+ *
+ * Filter::SNRDFir::Filter<int32_t,int32_t,7,
+ *                         Filter::SNRDFir::internal::SharedCoefficients<int32_t,7>,
+ *                         Filter::ShiftDelayLine<int32_t,7>> filter;
+ *
+ * process_blocks() is the block loop all process() functions share.
+ */
+
+namespace exmath::Filter {
+
+/**
+ * what the filters expect from a delay line policy
+ */
+template<class D, typename T>
+concept delay_line_policy = requires( D line, const D & const_line, T sample, T * out, const T * in, unsigned i )
+{
+	{ D::size } -> std::convertible_to<unsigned>;
+	{ D::contiguous } -> std::convertible_to<bool>;
+	line.push( sample );
+	{ const_line[i] } -> std::convertible_to<T>;
+	const_line.copy_to( out );
+	line.assign( in );
+};
+
+template <typename T, unsigned N>
+class MirroredDelayLine
+{
+public:
+	static constexpr unsigned size = N;
+	static constexpr bool contiguous = true;
+
+private:
+	/**
+	 * every sample is stored twice (at index and index + N),
+	 * so the last N samples are always contiguous at &buffer[index]
+	 */
+	std::array<T, 2*N> buffer{};
+	unsigned index = 0;
+
+public:
+	constexpr void push( T sample )
+	{
+		buffer[index] = sample;
+		buffer[index + N] = sample;
+
+		if( ++index == N ) {
+			index = 0;
+		}
+	}
+
+	/**
+	 * the last N samples, oldest first
+	 */
+	constexpr const T * window() const {
+		return &buffer[index];
+	}
+
+	constexpr T operator[]( unsigned i ) const {
+		return buffer[index + i];
+	}
+
+	/**
+	 * copies the last N samples, oldest first
+	 */
+	constexpr void copy_to( T * out ) const {
+		std::copy_n( window(), N, out );
+	}
+
+	/**
+	 * replaces the history with N samples, oldest first
+	 */
+	constexpr void assign( const T * in )
+	{
+		std::copy_n( in, N, buffer.begin() );
+		std::copy_n( in, N, buffer.begin() + N );
+		index = 0;
+	}
+};
+
+template <typename T, unsigned N>
+class MaskedDelayLine
+{
+public:
+	static constexpr unsigned size = N;
+	static constexpr bool contiguous = false;
+
+private:
+	static constexpr unsigned capacity = std::bit_ceil( N );
+	static constexpr unsigned mask = capacity - 1;
+
+	std::array<T, capacity> buffer{};
+	unsigned head = 0;               // next write position, wraps with the mask
+
+public:
+	constexpr void push( T sample )
+	{
+		buffer[head] = sample;
+		head = ( head + 1 ) & mask;
+	}
+
+	constexpr T operator[]( unsigned i ) const {
+		return buffer[( head - N + i ) & mask];
+	}
+
+	constexpr void copy_to( T * out ) const
+	{
+		for( unsigned i = 0; i < N; ++i ) {
+			out[i] = (*this)[i];
+		}
+	}
+
+	/**
+	 * replaces the history with N samples, oldest first,
+	 * written through the index mapping of operator[]
+	 */
+	constexpr void assign( const T * in )
+	{
+		for( unsigned i = 0; i < N; ++i ) {
+			buffer[( head - N + i ) & mask] = in[i];
+		}
+	}
+};
+
+template <typename T, unsigned N>
+class ShiftDelayLine
+{
+public:
+	static constexpr unsigned size = N;
+	static constexpr bool contiguous = true;
+
+private:
+	std::array<T, N> buffer{};       // oldest first
+
+public:
+	constexpr void push( T sample )
+	{
+		std::copy( buffer.begin() + 1, buffer.end(), buffer.begin() );
+		buffer[N-1] = sample;
+	}
+
+	constexpr const T * window() const {
+		return buffer.data();
+	}
+
+	constexpr T operator[]( unsigned i ) const {
+		return buffer[i];
+	}
+
+	constexpr void copy_to( T * out ) const {
+		std::copy_n( buffer.begin(), N, out );
+	}
+
+	constexpr void assign( const T * in ) {
+		std::copy_n( in, N, buffer.begin() );
+	}
+};
+
+/**
+ * MirroredDelayLine with the length chosen at runtime, for DynamicFilter
+ */
+template <typename T>
+class DynamicMirroredDelayLine
+{
+	std::vector<T> buffer;
+	unsigned size;
+	unsigned index = 0;
+
+public:
+	explicit DynamicMirroredDelayLine( unsigned size_ )
+	: buffer( 2 * size_ ),
+	  size( size_ )
+	{
+	}
+
+	void push( T sample )
+	{
+		buffer[index] = sample;
+		buffer[index + size] = sample;
+
+		// no modulo, size is not a constant here
+		if( ++index == size ) {
+			index = 0;
+		}
+	}
+
+	const T * window() const {
+		return &buffer[index];
+	}
+
+	T operator[]( unsigned i ) const {
+		return buffer[index + i];
+	}
+
+	void copy_to( T * out ) const {
+		std::copy_n( window(), size, out );
+	}
+
+	void assign( const T * in )
+	{
+		std::copy_n( in, size, buffer.begin() );
+		std::copy_n( in, size, buffer.begin() + size );
+		index = 0;
+	}
+};
+
+/**
+ * The block loop of the process() functions.
+ *
+ * The last taps samples of delay_line, oldest first, followed by up to
+ * window.size() - taps new samples are copied into window, so the kernels
+ * see contiguous samples without any index wrap. evaluate( w, pos, count )
+ * calculates the outputs for in[pos] ... in[pos+count-1], the one for
+ * in[pos+k] from w[k] ... w[k+taps-1]. Afterwards delay_line holds the
+ * last taps samples, like after pushing them one by one.
+ */
+template<class DelayLine, class Window, typename T, class Evaluate>
+void process_blocks( DelayLine & delay_line, unsigned taps, Window & window, std::span<const T> in, Evaluate evaluate )
+{
+	const std::size_t block_size = window.size() - taps;
+
+	delay_line.copy_to( window.data() );
+
+	for( std::size_t pos = 0; pos < in.size(); ) {
+		const std::size_t count = std::min( block_size, in.size() - pos );
+
+		std::copy_n( in.begin() + pos, count, window.begin() + taps );
+
+		evaluate( &window[1], pos, count );
+
+		// the newest taps samples are the history of the next chunk
+		std::copy_n( window.begin() + count, taps, window.begin() );
+		pos += count;
+	}
+
+	delay_line.assign( window.data() );
+}
+
+} // namespace exmath::Filter
@@ -0,0 +1,675 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <concepts>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <numbers>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "SNRDFir.hpp"
+#include "SNRDDynamic.hpp"
+
+/*
+ * FFT overlap-save convolution for long filters in batch processing.
+ *
+ * The direct form costs N multiply-adds per sample, the overlap-save
+ * engine O(log N). The FFT is a self contained iterative radix-2 one,
+ * no external libraries are required.
+ *
+ * Two real input segments are transformed at once, one in the real and
+ * one in the imaginary part. Since the taps are real, the filtered
+ * segments come out in the real and imaginary part again.
+ *
+ * The results are not bit identical to the direct form, they differ by
+ * the rounding errors of the FFT.
+ *
+ * BlockFilter only uses the FFT engine for blocks long enough, by a fixed
+ * rule, or by a measurement on this machine after calibrate():
+ *
+ * Filter::SNRDFir::BlockFilter<double,double,397*2+1> filter;
+ * filter.calibrate();
+ *
+ * filter.process( recording, result );
+ *
+ * or with N from a config file:
+ *
+ * Filter::SNRDFir::DynamicBlockFilter<double,double> filter( config.taps );
+ */
+
+namespace exmath::Filter::fft {
+
+/**
+ * complex in place FFT of a fixed power of two size
+ */
+class FFT
+{
+	std::size_t size;
+	// twiddle factors of all stages, stage with length len starts at len/2 - 1
+	std::vector<std::complex<double>> twiddles;
+	std::vector<std::size_t> bit_reverse;
+
+public:
+	explicit FFT( std::size_t size_ )
+	: size( size_ ),
+	  twiddles( size_ ),
+	  bit_reverse( size_ )
+	{
+		if( size < 2 || ( size & ( size - 1 ) ) != 0 ) {
+			throw std::invalid_argument("FFT size has to be a power of two.");
+		}
+
+		for( std::size_t len = 2; len <= size; len *= 2 ) {
+			for( std::size_t k = 0; k < len / 2; ++k ) {
+				twiddles[len / 2 - 1 + k] = std::polar( 1.0, -2.0 * std::numbers::pi * double(k) / double(len) );
+			}
+		}
+
+		unsigned bits = 0;
+		while( ( std::size_t(1) << bits ) < size ) {
+			++bits;
+		}
+
+		for( std::size_t i = 0; i < size; ++i ) {
+			std::size_t r = 0;
+			for( unsigned b = 0; b < bits; ++b ) {
+				r |= ( ( i >> b ) & 1 ) << ( bits - 1 - b );
+			}
+			bit_reverse[i] = r;
+		}
+	}
+
+	std::size_t get_size() const {
+		return size;
+	}
+
+	void forward( std::complex<double> * data ) const {
+		transform( data, false );
+	}
+
+	/**
+	 * unscaled, the result has to be divided by get_size()
+	 */
+	void inverse( std::complex<double> * data ) const {
+		transform( data, true );
+	}
+
+private:
+	void transform( std::complex<double> * data, bool inverse ) const
+	{
+		for( std::size_t i = 0; i < size; ++i ) {
+			if( i < bit_reverse[i] ) {
+				std::swap( data[i], data[bit_reverse[i]] );
+			}
+		}
+
+		// the conjugated twiddle factors give the inverse transform
+		const double sign = inverse ? -1.0 : 1.0;
+
+		for( std::size_t len = 2; len <= size; len *= 2 ) {
+			const std::size_t half = len / 2;
+			const std::complex<double> * w = &twiddles[half - 1];
+
+			for( std::size_t start = 0; start < size; start += len ) {
+				std::complex<double> * lo = data + start;
+				std::complex<double> * hi = data + start + half;
+
+				for( std::size_t k = 0; k < half; ++k ) {
+					// written out, std::complex multiplication has to care about inf and nan
+					const double wr = w[k].real();
+					const double wi = sign * w[k].imag();
+					const double br = hi[k].real() * wr - hi[k].imag() * wi;
+					const double bi = hi[k].real() * wi + hi[k].imag() * wr;
+					const double ar = lo[k].real();
+					const double ai = lo[k].imag();
+
+					lo[k] = std::complex<double>( ar + br, ai + bi );
+					hi[k] = std::complex<double>( ar - br, ai - bi );
+				}
+			}
+		}
+	}
+};
+
+/**
+ * Overlap-save engine for an arbitrary real tap set.
+ *
+ * out[n] = scale * sum( taps[i] * x[n-(N-1)+i] )
+ *
+ * So taps are applied to the last N samples, oldest first,
+ * like the SNRD coefficients.
+ */
+template <std::floating_point T>
+class OverlapSave
+{
+	std::size_t taps_count;
+	std::vector<double> taps;
+	FFT fft;
+	std::vector<std::complex<double>> spectrum;   // scaled transfer function
+	std::vector<std::complex<double>> work;
+	std::vector<T> history;                       // last N-1 samples, oldest first
+
+public:
+	/**
+	 * fft_size 0 chooses the size automatically
+	 */
+	OverlapSave( std::span<const double> taps_, double scale, std::size_t fft_size = 0 )
+	: taps_count( taps_.size() ),
+	  taps( taps_.begin(), taps_.end() ),
+	  fft( fft_size ? fft_size : default_fft_size( taps_.size() ) ),
+	  spectrum( fft.get_size() ),
+	  work( fft.get_size() ),
+	  history( taps_.size() - 1 )
+	{
+		if( taps_count == 0 || fft.get_size() < 2 * taps_count ) {
+			throw std::invalid_argument("FFT size too small for this number of taps.");
+		}
+
+		set_scale( scale );
+	}
+
+	/**
+	 * about 8 times the filter length is a good compromise between
+	 * the cost of the FFT and the share of useful outputs per block.
+	 */
+	static std::size_t default_fft_size( std::size_t taps_count )
+	{
+		std::size_t size = 64;
+
+		while( size < 8 * taps_count ) {
+			size *= 2;
+		}
+
+		return size;
+	}
+
+	/**
+	 * number of new samples one FFT block processes
+	 */
+	std::size_t get_step() const {
+		return fft.get_size() - ( taps_count - 1 );
+	}
+
+	void set_scale( double scale )
+	{
+		const std::size_t L = fft.get_size();
+
+		// the convolution kernel is the time reversed tap set
+		std::fill( spectrum.begin(), spectrum.end(), 0 );
+		for( std::size_t d = 0; d < taps_count; ++d ) {
+			spectrum[d] = taps[taps_count - 1 - d];
+		}
+
+		fft.forward( spectrum.data() );
+
+		// fold the scale and the 1/L of the inverse FFT into the spectrum
+		const double factor = scale / double(L);
+		for( auto & s : spectrum ) {
+			s *= factor;
+		}
+	}
+
+	/**
+	 * appends samples to the history without producing outputs
+	 */
+	void push_history( std::span<const T> in )
+	{
+		if( history.empty() ) {
+			return;
+		}
+
+		if( in.size() >= history.size() ) {
+			std::copy( in.end() - history.size(), in.end(), history.begin() );
+			return;
+		}
+
+		std::copy( history.begin() + in.size(), history.end(), history.begin() );
+		std::copy( in.begin(), in.end(), history.end() - in.size() );
+	}
+
+	void process( std::span<const T> in, std::span<T> out )
+	{
+		if( out.size() < in.size() ) {
+			throw std::invalid_argument("Output block is smaller than the input block.");
+		}
+
+		const std::size_t L = fft.get_size();
+		const std::size_t H = taps_count - 1;
+		const std::size_t step = get_step();
+
+		for( std::size_t pos = 0; pos < in.size(); ) {
+			const std::size_t count_a = std::min( step, in.size() - pos );
+			const std::size_t count_b = std::min( step, in.size() - pos - count_a );
+
+			// segment a: history + count_a samples, segment b directly follows segment a
+			for( std::size_t i = 0; i < L; ++i ) {
+				double a = 0;
+				double b = 0;
+
+				if( i < H ) {
+					a = history[i];
+				} else if( i - H < count_a ) {
+					a = in[pos + i - H];
+				}
+
+				if( count_b > 0 ) {
+					const std::size_t src = pos + count_a + i - H;
+					if( i - H < count_b || i < H ) {
+						b = in[src];
+					}
+				}
+
+				work[i] = std::complex<double>( a, b );
+			}
+
+			fft.forward( work.data() );
+
+			for( std::size_t i = 0; i < L; ++i ) {
+				const double wr = work[i].real();
+				const double wi = work[i].imag();
+				const double sr = spectrum[i].real();
+				const double si = spectrum[i].imag();
+
+				work[i] = std::complex<double>( wr * sr - wi * si, wr * si + wi * sr );
+			}
+
+			fft.inverse( work.data() );
+
+			for( std::size_t k = 0; k < count_a; ++k ) {
+				out[pos + k] = work[H + k].real();
+			}
+
+			for( std::size_t k = 0; k < count_b; ++k ) {
+				out[pos + count_a + k] = work[H + k].imag();
+			}
+
+			push_history( in.subspan( pos, count_a + count_b ) );
+			pos += count_a + count_b;
+		}
+	}
+};
+
+} // namespace exmath::Filter::fft
+
+namespace exmath::Filter::SNRDFir {
+
+/**
+ * SNRD differentiator evaluated by overlap-save FFT convolution.
+ */
+template <std::floating_point T, std::floating_point C, unsigned N>
+class FFTFilter
+{
+	C default_denominator = Filter<T,C,N>().get_default_denominator();
+	fft::OverlapSave<T> engine;
+
+public:
+	FFTFilter( std::size_t fft_size = 0 )
+	: engine( calc_taps(), 1.0 / double(default_denominator), fft_size )
+	{}
+
+	void process( std::span<const T> in, std::span<T> out ) {
+		engine.process( in, out );
+	}
+
+	void push_history( std::span<const T> in ) {
+		engine.push_history( in );
+	}
+
+	/**
+	 * number of new samples one FFT block processes
+	 */
+	std::size_t get_step() const {
+		return engine.get_step();
+	}
+
+	C get_default_denominator() const {
+		return default_denominator;
+	}
+
+	void set_default_denominator( C dd ) {
+		default_denominator = dd;
+		engine.set_scale( 1.0 / double(dd) );
+	}
+
+private:
+	static std::array<double, N> calc_taps()
+	{
+		std::array<double, N> taps{};
+		const auto coefficients = Filter<T,C,N>::get_coefficients();
+
+		std::copy( coefficients.begin(), coefficients.end(), taps.begin() );
+
+		return taps;
+	}
+};
+
+/**
+ * FFTFilter with the number of taps chosen at runtime,
+ * the taps are the ones of DynamicFilter<T,C>.
+ */
+template <std::floating_point T, std::floating_point C>
+class DynamicFFTFilter
+{
+	unsigned taps;
+	C default_denominator;
+	fft::OverlapSave<T> engine;
+
+public:
+	explicit DynamicFFTFilter( unsigned taps_, std::size_t fft_size = 0 )
+	: DynamicFFTFilter( DynamicFilter<T,C>( taps_ ), fft_size )
+	{}
+
+	unsigned get_taps() const {
+		return taps;
+	}
+
+	void process( std::span<const T> in, std::span<T> out ) {
+		engine.process( in, out );
+	}
+
+	void push_history( std::span<const T> in ) {
+		engine.push_history( in );
+	}
+
+	std::size_t get_step() const {
+		return engine.get_step();
+	}
+
+	C get_default_denominator() const {
+		return default_denominator;
+	}
+
+	void set_default_denominator( C dd ) {
+		default_denominator = dd;
+		engine.set_scale( 1.0 / double(dd) );
+	}
+
+private:
+	DynamicFFTFilter( const DynamicFilter<T,C> & filter, std::size_t fft_size )
+	: taps( filter.get_taps() ),
+	  default_denominator( filter.get_default_denominator() ),
+	  engine( calc_taps( filter ), 1.0 / double(default_denominator), fft_size )
+	{}
+
+	static std::vector<double> calc_taps( const DynamicFilter<T,C> & filter )
+	{
+		const std::vector<C> coefficients = filter.get_coefficients();
+
+		return std::vector<double>( coefficients.begin(), coefficients.end() );
+	}
+};
+
+namespace internal {
+
+	/**
+	 * Chooses per block between a direct form engine and an FFT engine
+	 * with the same taps. Both share the same history, so they can be
+	 * mixed freely.
+	 *
+	 * Blocks of at least fft_min_block_size samples go to the FFT engine.
+	 * The default is a fixed rule, see default_fft_min_block_size(), so the
+	 * results don't depend on the machine. calibrate() measures the size
+	 * instead, once per engine type, number of taps and instruction set.
+	 */
+	template <class DIRECT, class FFT, typename T, typename C>
+	class BasicBlockFilter
+	{
+	protected:
+		DIRECT direct;
+		FFT fft;
+		std::size_t fft_min_block_size;
+
+	public:
+		/**
+		 * block sizes measured, as multiples of the samples two FFT blocks process
+		 */
+		static constexpr std::array<std::size_t, 5> measured_factors = { 1, 2, 4, 8, 16 };
+
+		/**
+		 * The crossover of default_fft_min_block_size() was measured with
+		 * the SIMD direct form (AVX-512, double) against the overlap-save
+		 * engine, ns per sample with 65536 sample blocks:
+		 *
+		 *   taps      127    255    795
+		 *   direct     17     32     83
+		 *   fft        24     28     30
+		 *
+		 * With blocks of 4096 samples the FFT only breaks even at 795 taps,
+		 * so a block has to span several FFT sizes.
+		 */
+		static constexpr std::size_t default_fft_min_taps = 255;
+		static constexpr std::size_t default_fft_min_block_factor = 8;
+
+		BasicBlockFilter( const DIRECT & direct_, const FFT & fft_ )
+		: BasicBlockFilter( direct_, fft_, default_fft_min_block_size( direct_, fft_ ) )
+		{}
+
+		/**
+		 * fft_min_block_size 0 never uses the FFT engine
+		 */
+		BasicBlockFilter( const DIRECT & direct_, const FFT & fft_, std::size_t fft_min_block_size_ )
+		: direct( direct_ ),
+		  fft( fft_ ),
+		  fft_min_block_size( fft_min_block_size_ )
+		{}
+
+		/**
+		 * returns true, if a block of this size is processed by the FFT engine
+		 */
+		bool use_fft( std::size_t block_size ) const
+		{
+			// the direct form gets the last taps samples of an FFT block
+			return fft_min_block_size != 0
+				&& block_size >= fft_min_block_size
+				&& block_size >= taps_of( direct );
+		}
+
+		std::size_t get_fft_min_block_size() const {
+			return fft_min_block_size;
+		}
+
+		void set_fft_min_block_size( std::size_t size ) {
+			fft_min_block_size = size;
+		}
+
+		/**
+		 * Measures the block size the FFT engine gets faster from on the
+		 * active instruction set and uses it from now on. The measurement is
+		 * done once per process for every number of taps, so it's cheap to
+		 * call for every filter. The results of a block depend on the engine
+		 * it goes to, so they may differ slightly from machine to machine then.
+		 *
+		 * Returns the new fft_min_block_size.
+		 */
+		std::size_t calibrate()
+		{
+			fft_min_block_size = cached_fft_min_block_size( direct, fft );
+			return fft_min_block_size;
+		}
+
+		/**
+		 * The FFT engine from default_fft_min_taps on,
+		 * for blocks of default_fft_min_block_factor FFT sizes
+		 */
+		static std::size_t default_fft_min_block_size( const DIRECT & direct, const FFT & fft )
+		{
+			const std::size_t taps = taps_of( direct );
+
+			if( taps < default_fft_min_taps ) {
+				return 0;
+			}
+
+			// an FFT block holds the new samples and the taps - 1 ones before them
+			return default_fft_min_block_factor * ( fft.get_step() + taps - 1 );
+		}
+
+		void process( std::span<const T> in, std::span<T> out )
+		{
+			if( use_fft( in.size() ) ) {
+				fft.process( in, out );
+
+				for( const T & x : in.last( taps_of( direct ) ) ) {
+					direct.add( x );
+				}
+			} else {
+				direct.process( in, out );
+				fft.push_history( in );
+			}
+		}
+
+		/**
+		 * result for the last sample passed to process()
+		 */
+		T get_result() {
+			return direct.get_result();
+		}
+
+		C get_default_denominator() const {
+			return direct.get_default_denominator();
+		}
+
+		void set_default_denominator( C dd ) {
+			direct.set_default_denominator( dd );
+			fft.set_default_denominator( dd );
+		}
+
+		/**
+		 * The smallest block size of measured_factors the FFT engine is
+		 * faster for on the active instruction set, 0 if it is never faster.
+		 * Runs on copies, the engines passed are not changed.
+		 */
+		static std::size_t measure_fft_min_block_size( DIRECT direct, FFT fft )
+		{
+			const std::size_t pair = 2 * fft.get_step();
+
+			std::vector<T> in( pair * measured_factors.back() );
+			std::vector<T> out( in.size() );
+
+			for( std::size_t i = 0; i < in.size(); ++i ) {
+				in[i] = T( int( i * 7919 % 4096 ) - 2048 ) / T( 512 );
+			}
+
+			for( std::size_t factor : measured_factors ) {
+				const std::span<const T> block( in.data(), pair * factor );
+				const std::span<T> result( out.data(), pair * factor );
+
+				const auto fft_time = fastest_run( [&]() { fft.process( block, result ); } );
+				const auto direct_time = fastest_run( [&]() { direct.process( block, result ); } );
+
+				if( fft_time < direct_time ) {
+					return block.size();
+				}
+			}
+
+			return 0;
+		}
+
+	private:
+		template<class Run>
+		static std::chrono::steady_clock::duration fastest_run( Run run )
+		{
+			auto fastest = std::chrono::steady_clock::duration::max();
+
+			for( unsigned i = 0; i < 3; ++i ) {
+				const auto start = std::chrono::steady_clock::now();
+				run();
+				fastest = std::min( fastest, std::chrono::steady_clock::now() - start );
+			}
+
+			return fastest;
+		}
+
+		static std::size_t taps_of( const DIRECT & direct )
+		{
+			if constexpr( requires { DIRECT::taps; } ) {
+				return DIRECT::taps;
+			} else {
+				return direct.get_taps();
+			}
+		}
+
+		/**
+		 * measured once per process for every number of taps and instruction set
+		 */
+		static std::size_t cached_fft_min_block_size( const DIRECT & direct, const FFT & fft )
+		{
+			static std::mutex mutex;
+			static std::map<std::pair<std::size_t, simd::ISA>, std::size_t> sizes;
+
+			std::lock_guard<std::mutex> lock( mutex );
+
+			const std::pair<std::size_t, simd::ISA> key( taps_of( direct ), simd::active_isa() );
+			auto it = sizes.find( key );
+
+			if( it == sizes.end() ) {
+				it = sizes.emplace( key, measure_fft_min_block_size( direct, fft ) ).first;
+			}
+
+			return it->second;
+		}
+	};
+
+} // namespace internal
+
+/**
+ * Chooses per block between Filter<T,C,N> and FFTFilter<T,C,N>.
+ *
+ * The FFT engine only pays off for long filters and blocks spanning
+ * several FFT sizes, where exactly depends on T, C, N and the instruction
+ * set of the direct form. The smallest block size for the FFT engine is
+ * a fixed default, passed to the constructor or measured by calibrate().
+ */
+template <std::floating_point T, std::floating_point C, unsigned N>
+class BlockFilter : public internal::BasicBlockFilter<Filter<T,C,N>, FFTFilter<T,C,N>, T, C>
+{
+	typedef internal::BasicBlockFilter<Filter<T,C,N>, FFTFilter<T,C,N>, T, C> Base;
+
+public:
+	static constexpr unsigned taps = N;
+
+	BlockFilter()
+	: Base( Filter<T,C,N>(), FFTFilter<T,C,N>() )
+	{}
+
+	/**
+	 * fft_min_block_size 0 never uses the FFT engine
+	 */
+	explicit BlockFilter( std::size_t fft_min_block_size )
+	: Base( Filter<T,C,N>(), FFTFilter<T,C,N>(), fft_min_block_size )
+	{}
+};
+
+/**
+ * BlockFilter with the number of taps chosen at runtime,
+ * between DynamicFilter<T,C> and DynamicFFTFilter<T,C>.
+ */
+template <std::floating_point T, std::floating_point C>
+class DynamicBlockFilter : public internal::BasicBlockFilter<DynamicFilter<T,C>, DynamicFFTFilter<T,C>, T, C>
+{
+	typedef internal::BasicBlockFilter<DynamicFilter<T,C>, DynamicFFTFilter<T,C>, T, C> Base;
+
+public:
+	explicit DynamicBlockFilter( unsigned taps )
+	: Base( DynamicFilter<T,C>( taps ), DynamicFFTFilter<T,C>( taps ) )
+	{}
+
+	/**
+	 * fft_min_block_size 0 never uses the FFT engine
+	 */
+	DynamicBlockFilter( unsigned taps, std::size_t fft_min_block_size )
+	: Base( DynamicFilter<T,C>( taps ), DynamicFFTFilter<T,C>( taps ), fft_min_block_size )
+	{}
+
+	unsigned get_taps() const {
+		return this->direct.get_taps();
+	}
+};
+
+} // namespace exmath::Filter::SNRDFir
@@ -1,25 +1,33 @@
 #pragma once
 #include <array>
 #include <concepts>
+#include <cstddef>
 #include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include "DelayLine.hpp"
+#include "SimdKernels.hpp"
 
 
-template <class T, class C, int size>
+template <class T, class C, int size, class DelayLine = exmath::Filter::MirroredDelayLine<T, size>>
     requires(std::integral<T> || std::floating_point<T>)
             && (std::integral<C> || std::floating_point<C> && size > 1)
+            && exmath::Filter::delay_line_policy<DelayLine, T> && (DelayLine::size == unsigned(size))
 class FIRFilter
 {
 private:
-    std::array<T, size> m_x;                   // Input buffer
-    const std::array<C, size> m_coefficients;  // Coefficients
+    DelayLine m_x;                             // Input buffer, the last size inputs, see DelayLine.hpp
+    const std::array<C, size> m_coefficients;  // Coefficients, in the order of m_x, see window_order()
     T m_output = 0;
-    int16_t m_index = 0;
 
 public:
+    // number of samples the block filter() linearizes at once
+    static constexpr std::size_t block_window_size = 256;
+
     constexpr FIRFilter(const std::array<C, size>& init)
-        : m_coefficients(init)
+        : m_coefficients(window_order(init))
     {
-        m_x.fill(0);
     }
 
     constexpr T getOutput() const { return m_output; }
@@ -27,18 +35,103 @@ public:
 
     constexpr T filter(T input)
     {
-        // Convert input to float for processing
-        m_x[m_index] = input;
+        m_x.push(input);
 
-        C output = 0;
-        for (int i = 0; i < size; i++)
+        C output;
+        if constexpr (std::integral<C> && exmath::Filter::simd::supported_pair<T, C> && DelayLine::contiguous)
+        {
+            // integer sums are exact in any order, so the result is the same on every instruction set
+            if (std::is_constant_evaluated())
+                output = accumulate(m_x.window());
+            else
+                output = exmath::Filter::simd::dot(m_x.window(), m_coefficients.data(), size);
+        }
+        else if constexpr (DelayLine::contiguous)
         {
-            output += m_coefficients[i] * m_x[(m_index + i) % size];
+            output = accumulate(m_x.window());
+        }
+        else
+        {
+            output = accumulate(m_x);
         }
         m_output = output;
-        m_index = (m_index + 1) % size;
         return m_output;
     }
+
+    // Filters a whole block, out[k] gets exactly the value filter(in[k])
+    // would have returned. One output per vector lane, each summed in the
+    // order of filter(), so the results don't depend on the instruction set.
+    void filter(std::span<const T> in, std::span<T> out)
+    {
+        if (out.size() < in.size())
+        {
+            throw std::invalid_argument("Output block is smaller than the input block.");
+        }
+
+        std::array<T, size + block_window_size> window;
+        std::array<C, block_window_size> sums;
+
+        exmath::Filter::process_blocks(m_x, size, window, in, [&](const T* w, std::size_t pos, std::size_t count) {
+            if constexpr (exmath::Filter::simd::supported_pair<T, C>)
+                exmath::Filter::simd::fir_block(w, m_coefficients.data(), size, sums.data(), count);
+            else
+                exmath::Filter::simd::scalar::fir_block(w, m_coefficients.data(), size, sums.data(), count);
+
+            for (std::size_t k = 0; k < count; k++)
+            {
+                out[pos + k] = sums[k];
+            }
+        });
+
+        if (!in.empty())
+        {
+            m_output = out[in.size() - 1];
+        }
+    }
+
+private:
+    // The first tap applies to the newest input, the others to the inputs
+    // before it, oldest first. Rotated into the order of the delay line,
+    // oldest input first, every output is a plain dot product of the window.
+    static constexpr std::array<C, size> window_order(const std::array<C, size>& taps)
+    {
+        std::array<C, size> rotated{};
+        for (int i = 1; i < size; i++)
+        {
+            rotated[i - 1] = taps[i];
+        }
+        rotated[size - 1] = taps[0];
+        return rotated;
+    }
+
+    template <class Window>
+    constexpr C accumulate(const Window& x) const
+    {
+        if constexpr (std::floating_point<C>)
+            return accumulate_uncontracted(x);
+        else
+            return sum_taps(x);
+    }
+
+    // without fused multiply adds, so float and double results are the
+    // ones of the constant evaluation and of the block filter() on every target
+    template <class Window>
+    EXMATH_NO_FP_CONTRACT constexpr C accumulate_uncontracted(const Window& x) const
+    {
+        return sum_taps(x);
+    }
+
+    // the order of simd::scalar::fir_block()
+    template <class Window>
+    [[gnu::always_inline]] constexpr C sum_taps(const Window& x) const
+    {
+        C output = 0;
+        for (int i = 0; i < size; i++)
+        {
+            output += m_coefficients[i] * C(x[i]);
+        }
+        return output;
+    }
 };
 
 constexpr bool FIRTest()
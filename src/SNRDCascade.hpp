@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include "SNRDFir.hpp"
+
+/*
+ * Multiplier free engine for integer Smooth Noise Robust Differentiators.
+ *
+ * The SNRD taps of length N are the coefficients of the polynomial
+ *
+ *   ( 1 - z^-2 ) * ( 1 + z^-1 )^(N-3)
+ *
+ * which is what the repeated additions of the catalan triangle build.
+ * So the filter can be evaluated as one difference stage x[n] - x[n-2]
+ * followed by N-3 cascaded [1,1] summing stages, using only additions
+ * and subtractions per sample.
+ *
+ * The arithmetic wraps around like the direct form does, so the results
+ * are exactly the same as the ones of Filter<T,C,N>.
+ *
+ * Filter::SNRDFir::CascadeFilter<int64_t,int64_t,27*2+1> filter;
+ *
+ * while( ... )
+ *   current_result = filter( adc_value );
+ */
+
+namespace exmath::Filter::SNRDFir {
+
+template <typename T, typename C, unsigned N>
+requires internal::odds_only<unsigned, N>
+	&& std::is_integral_v<T> && std::is_integral_v<C>
+	&& ( N >= 5 )
+class CascadeFilter
+{
+protected:
+	// unsigned arithmetic, so an overflow wraps the same way as in the direct form
+	typedef std::make_unsigned_t<C> U;
+
+	std::array<U, 2>   diff_delay{};      // x[n-1], x[n-2]
+	std::array<U, N-3> stage_delay{};     // previous input of each [1,1] stage
+
+	C       sum = 0;
+	internal::Normalizer<C> normalizer{ calc_default_denominator() };
+
+public:
+	/**
+	 * number of taps, the output depends on the last taps input samples
+	 */
+	static constexpr unsigned taps = N;
+
+	/**
+	 * number of samples process() runs through the cascade at once
+	 */
+	static constexpr unsigned block_window_size = 256;
+
+	/**
+	 * Runs the sample through all stages. Unlike Filter::add()
+	 * every sample has to pass the cascade, so the sum is ready afterwards.
+	 */
+	void add(T input)
+	{
+		const U x = static_cast<U>( static_cast<C>( input ) );
+
+		U v = x - diff_delay[1];
+		diff_delay[1] = diff_delay[0];
+		diff_delay[0] = x;
+
+		for( U & prev : stage_delay ) {
+			const U next = v + prev;
+			prev = v;
+			v = next;
+		}
+
+		sum = static_cast<C>( v );
+	}
+
+	/**
+	 * returns the sum of the current sample
+	 */
+	C calculate() const
+	{
+		return sum;
+	}
+
+	/**
+	 * adds the new input value and returns the devided result
+	 */
+	T operator()( T input )
+	{
+		add( input );
+		return get_result();
+	}
+
+	/**
+	 * Filters a whole block of samples.
+	 * out[k] gets exactly the value operator()( in[k] ) would have returned.
+	 *
+	 * The block runs stage by stage through the cascade. Within one stage
+	 * the outputs are independent of each other, so the additions can be
+	 * vectorized instead of forming one long dependency chain per sample.
+	 */
+	void process( std::span<const T> in, std::span<T> out )
+	{
+		if( out.size() < in.size() ) {
+			throw std::invalid_argument("Output block is smaller than the input block.");
+		}
+
+		// element 0 holds the previous input of the current stage
+		std::array<U, block_window_size + 2> a;
+		std::array<U, block_window_size + 2> b;
+
+		for( size_t pos = 0; pos < in.size(); ) {
+			const size_t count = std::min<size_t>( block_window_size, in.size() - pos );
+
+			// difference stage: x[n] - x[n-2]
+			a[0] = diff_delay[1];
+			a[1] = diff_delay[0];
+
+			for( size_t k = 0; k < count; ++k ) {
+				a[k+2] = static_cast<U>( static_cast<C>( in[pos + k] ) );
+			}
+
+			for( size_t k = 0; k < count; ++k ) {
+				b[k+1] = a[k+2] - a[k];
+			}
+
+			diff_delay[1] = a[count];
+			diff_delay[0] = a[count+1];
+
+			U * src = b.data();
+			U * dst = a.data();
+
+			for( U & prev : stage_delay ) {
+				src[0] = prev;
+				prev = src[count];
+
+				for( size_t k = 1; k <= count; ++k ) {
+					dst[k] = src[k] + src[k-1];
+				}
+
+				std::swap( src, dst );
+			}
+
+			for( size_t k = 0; k < count; ++k ) {
+				out[pos + k] = normalizer( static_cast<C>( src[k+1] ) );
+			}
+
+			sum = static_cast<C>( src[count] );
+			pos += count;
+		}
+	}
+
+	T get_result() const {
+		return normalizer( sum );
+	}
+
+	T get_last_result() const {
+		return normalizer( sum );
+	}
+
+	C get_default_denominator() const {
+		return normalizer.get();
+	}
+
+	void set_default_denominator( C dd ) {
+		normalizer.set( dd );
+	}
+
+private:
+	static constexpr C calc_default_denominator()
+	{
+		// same as Filter<T,C,N>, 2^(N-2)
+		constexpr C denominator = 8 * Filter<T,C,N>::template ipow<C>(4,N/2-2);
+		return denominator;
+	}
+};
+
+} // namespace exmath::Filter::SNRDFir
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include "DelayLine.hpp"
+#include "SNRDFir.hpp"
+
+/*
+ * Long SNRD differentiators in float.
+ *
+ * The taps of Filter are integers up to about 2^(N-2), float can't hold
+ * them beyond N = 127. Here they are normalized: tap / 2^(N-2), rounded
+ * once from the exact value, so the sum already is the result. Taps below
+ * the smallest normal number are set to 0, a subnormal operand makes every
+ * multiplication with it many times slower. Together they contribute less
+ * than 1e-35 per unit of input.
+ *
+ * Accumulation::ordered      the same order as Filter, outermost tap first.
+ *                            Rounding error up to about ( N/2 + 1 ) ulp of
+ *                            sum( |tap[i] * ( x[N-1-i] - x[i] )| ).
+ * Accumulation::compensated  blocks of simd::compensation_block taps, the
+ *                            block sums added with compensated summation,
+ *                            in every vector lane. Rounding error up to about
+ *                            compensation_block + 3 ulp of that sum.
+ *
+ * With 12 bit ADC values and N = 795 the compensated float results stay
+ * within 1e-6 of sum( |tap[i] * ( x[N-1-i] - x[i] )| ) of the double results
+ * of Filter<double,double,795>, at 1.5 to 2 times the throughput of double.
+ *
+ * M < N keeps only the central M taps of the N taps filter, the outer
+ * ones are dropped, see SNRDTruncated.hpp.
+ *
+ * Filter::SNRDFir::CompensatedFilter<float,float,397*2+1> filter;
+ *
+ * filter.process( adc_block, result_block );
+ */
+
+namespace exmath::Filter::SNRDFir {
+
+enum class Accumulation
+{
+	ordered,
+	compensated
+};
+
+namespace internal {
+
+	/**
+	 * the folded taps of Filter<T,C,N> divided by its default denominator
+	 */
+	template<typename C, unsigned N>
+	constexpr std::array<C, N/2> calc_normalized_folded_coefficients()
+	{
+		// same as the default denominator, 2^(N-2)
+		constexpr int exp2 = -static_cast<int>( N - 2 );
+
+		constexpr auto catalans_triangle = calc_last_line_of_catalan_triangle<C,N/2>( exp2 );
+
+		std::array<C, N/2> folded{};
+		std::reverse_copy( catalans_triangle.begin(), catalans_triangle.end(), folded.begin() );
+
+		for( C & c : folded ) {
+			if( c < std::numeric_limits<C>::min() ) {
+				c = 0;
+			}
+		}
+
+		return folded;
+	}
+
+	/**
+	 * calc_normalized_folded_coefficients() exact in long double, without the flush
+	 */
+	template<unsigned N>
+	constexpr std::array<long double, N/2> calc_exact_normalized_folded_coefficients()
+	{
+		constexpr auto catalans_triangle = calc_last_line_of_catalan_triangle<long double,N/2>( -static_cast<int>( N - 2 ) );
+
+		std::array<long double, N/2> folded{};
+		std::reverse_copy( catalans_triangle.begin(), catalans_triangle.end(), folded.begin() );
+
+		return folded;
+	}
+
+	/**
+	 * sum of the first dropped normalized folded taps
+	 */
+	constexpr long double calc_dropped_sum( std::span<const long double> folded, unsigned dropped )
+	{
+		long double sum = 0;
+
+		for( unsigned i = 0; i < dropped; ++i ) {
+			sum += folded[i];
+		}
+
+		return sum;
+	}
+
+} // namespace internal
+
+template <std::floating_point T, std::floating_point C, unsigned N,
+		  Accumulation mode = Accumulation::compensated, unsigned M = N>
+requires internal::odds_only<unsigned, N> && internal::odds_only<unsigned, M> && ( M >= 3 ) && ( M <= N )
+class CompensatedFilter
+{
+public:
+	/**
+	 * number of taps actually used, the output depends on the last taps input samples
+	 */
+	static constexpr unsigned taps = M;
+
+	/**
+	 * number of taps of the filter the taps are taken from
+	 */
+	static constexpr unsigned full_taps = N;
+
+	/**
+	 * number of samples process() linearizes at once
+	 */
+	static constexpr unsigned block_window_size = 256;
+
+	static constexpr bool has_simd_kernels = simd::supported_pair<T,C>;
+
+	/**
+	 * the central M/2 folded taps of the N taps filter,
+	 * outermost first, shared by all instances
+	 */
+	static constexpr std::array<C, M/2> folded_coefficients = []() {
+		constexpr std::array<C, N/2> full = internal::calc_normalized_folded_coefficients<C,N>();
+		std::array<C, M/2> folded{};
+		std::copy( full.end() - M/2, full.end(), folded.begin() );
+		return folded;
+	}();
+
+protected:
+	MirroredDelayLine<T,M> delay_line;
+
+	C       sum = 0;
+	C       output_scale = 1;
+	bool    dirty = true;
+
+public:
+	explicit CompensatedFilter( C output_scale_ = 1 )
+	: output_scale( output_scale_ )
+	{
+	}
+
+	/**
+	 * The most the dropped taps change a result by, for inputs up to |max_input|.
+	 * Without output_scale, 0 if no taps are dropped.
+	 */
+	static constexpr C truncation_error( C max_input )
+	{
+		constexpr std::array<long double, N/2> folded = internal::calc_exact_normalized_folded_coefficients<N>();
+
+		return static_cast<C>( 2 * static_cast<long double>( max_input ) * internal::calc_dropped_sum( folded, ( N - M ) / 2 ) );
+	}
+
+	/**
+	 * add data without calculating
+	 */
+	void add( T input )
+	{
+		delay_line.push( input );
+		dirty = true;
+	}
+
+	/**
+	 * Calculates the sum and stores it.
+	 * If no data was added since the last calculation the stored sum is returned.
+	 */
+	C calculate()
+	{
+		if( dirty ) {
+			// the scalar reference of the block kernels
+			window_sums( delay_line.window(), &sum, 1, simd::ISA::scalar );
+			dirty = false;
+		}
+
+		return sum;
+	}
+
+	/**
+	 * adds the new input value, calculates the filter and returns the scaled result
+	 */
+	T operator()( T input )
+	{
+		add( input );
+		return get_result();
+	}
+
+	/**
+	 * Filters a whole block of samples.
+	 * out[k] gets exactly the value operator()( in[k] ) would have returned.
+	 */
+	void process( std::span<const T> in, std::span<T> out )
+	{
+		if( out.size() < in.size() ) {
+			throw std::invalid_argument("Output block is smaller than the input block.");
+		}
+
+		std::array<T, M + block_window_size> window;
+
+		process_blocks( delay_line, M, window, in, [&]( const T * w, size_t pos, size_t count ) {
+			std::array<C, block_window_size> sums;
+			window_sums( w, sums.data(), count, simd::active_isa() );
+
+			for( size_t k = 0; k < count; ++k ) {
+				out[pos + k] = sums[k] * output_scale;
+			}
+
+			sum = sums[count-1];
+		});
+
+		if( !in.empty() ) {
+			dirty = false;
+		}
+	}
+
+	/**
+	 * calculate and return the scaled result
+	 * Calculates only, if data was added since the last calculation.
+	 */
+	T get_result() {
+		calculate();
+		return sum * output_scale;
+	}
+
+	/**
+	 * choose last sum and scale it
+	 */
+	T get_last_result() const {
+		return sum * output_scale;
+	}
+
+	/**
+	 * the results are multiplied by it, eg sample rate * volts per LSB
+	 */
+	C get_output_scale() const {
+		return output_scale;
+	}
+
+	void set_output_scale( C scale ) {
+		output_scale = scale;
+	}
+
+	/**
+	 * returns the unfolded, normalized taps actually used
+	 */
+	static constexpr std::array<C, M> get_coefficients()
+	{
+		std::array<C, M> coefficients{};
+
+		for( unsigned i = 0; i < M/2; ++i ) {
+			coefficients[M-1-i] = folded_coefficients[i];
+			coefficients[i] = -folded_coefficients[i];
+		}
+
+		return coefficients;
+	}
+
+	const std::array<C, M/2> & get_folded_coefficients() const {
+		return folded_coefficients;
+	}
+
+protected:
+	/**
+	 * sums[k] for the window w[k] ... w[k+M-1]
+	 */
+	static void window_sums( const T * w, C * sums, std::size_t count, simd::ISA isa )
+	{
+		if constexpr( has_simd_kernels ) {
+			const simd::Kernels<T,C> & kernels = simd::kernels_for<T,C>( isa );
+
+			if constexpr( mode == Accumulation::compensated ) {
+				kernels.folded_block_compensated( w, 1, folded_coefficients.data(), M, sums, count );
+			} else {
+				kernels.folded_block( w, 1, folded_coefficients.data(), M, sums, count );
+			}
+		} else {
+			if constexpr( mode == Accumulation::compensated ) {
+				simd::scalar::folded_block_compensated( w, 1, folded_coefficients.data(), M, sums, count );
+			} else {
+				simd::scalar::folded_block( w, 1, folded_coefficients.data(), M, sums, count );
+			}
+		}
+	}
+};
+
+} // namespace exmath::Filter::SNRDFir
@@ -0,0 +1,365 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "SNRDFir.hpp"
+
+/*
+ * SNRD differentiator with the number of taps chosen at runtime,
+ * eg from a config file.
+ *
+ * The taps are calculated once per N and type and shared by all filters
+ * of that length. Common lengths are dispatched to kernels compiled for
+ * exactly that N, all others use the generic kernels Filter uses as well.
+ *
+ * The results are exactly the ones of Filter<T,C,N>.
+ *
+ * Filter::SNRDFir::DynamicFilter<double,double> filter( config.taps );
+ *
+ * while( ... ) {
+ *   current_result = filter( adc_value );
+ * }
+ */
+
+namespace exmath::Filter::SNRDFir {
+
+namespace internal {
+
+	/**
+	 * the folded taps of Filter<T,C,taps>, outermost first
+	 */
+	template<typename C>
+	std::vector<C> calc_folded_coefficients( unsigned taps )
+	{
+		std::vector<C> folded = calc_last_line_of_catalan_triangle<C>( taps / 2 );
+		std::reverse( folded.begin(), folded.end() );
+		return folded;
+	}
+
+	/**
+	 * Process wide cache of the folded taps, one entry per N by default.
+	 * Entries are never removed, so the references stay valid.
+	 * Other tap sets use their own Key type, see SNRDTruncated.hpp.
+	 */
+	template<typename C, typename Key = unsigned>
+	class CoefficientRegistry
+	{
+		std::mutex mutex;
+		std::map<Key, std::vector<C>> entries;
+
+	public:
+		static CoefficientRegistry & instance()
+		{
+			static CoefficientRegistry registry;
+			return registry;
+		}
+
+		const std::vector<C> & get( unsigned taps ) requires std::is_same_v<Key, unsigned>
+		{
+			return get( taps, [taps]() { return calc_folded_coefficients<C>( taps ); } );
+		}
+
+		/**
+		 * calc() is called for the first request of key only
+		 */
+		template<class Calc>
+		const std::vector<C> & get( const Key & key, Calc calc )
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+
+			auto it = entries.find( key );
+
+			if( it == entries.end() ) {
+				it = entries.emplace( key, calc() ).first;
+			}
+
+			return it->second;
+		}
+	};
+
+} // namespace internal
+
+template <typename T, typename C>
+class DynamicFilter
+{
+public:
+	/**
+	 * lengths with their own kernels, the defaults of the tools and benchmarks
+	 */
+	static constexpr std::array<unsigned, 9> specialized_taps = { 5, 7, 9, 11, 15, 21, 27, 55, 127 };
+
+	/**
+	 * number of samples process() linearizes at once
+	 */
+	static constexpr unsigned block_window_size = 256;
+
+	static constexpr bool has_simd_kernels = simd::supported_pair<T,C>;
+
+protected:
+	struct Kernels
+	{
+		unsigned taps;         // 0 for the generic kernels
+		C    (*window_sum)( const T * x, const C * cf, unsigned n );
+		void (*block)( const T * w, const C * cf, unsigned n, C * sums, std::size_t count );
+	};
+
+	unsigned taps;
+	const std::vector<C> * folded_coefficients;
+	const Kernels * kernels;
+
+	/**
+	 * mirrored like in Filter, the last taps samples are always contiguous
+	 */
+	DynamicMirroredDelayLine<T> delay_line;
+
+	/**
+	 * taps samples of history followed by the new samples, used by process()
+	 */
+	std::vector<T> window;
+
+	C       sum = 0;
+	internal::Normalizer<C> normalizer;
+	bool    dirty = true;
+
+public:
+	explicit DynamicFilter( unsigned taps_ )
+	: taps( check_taps( taps_ ) ),
+	  folded_coefficients( &internal::CoefficientRegistry<C>::instance().get( taps ) ),
+	  kernels( select_kernels( taps ) ),
+	  delay_line( taps ),
+	  window( taps + block_window_size ),
+	  normalizer( internal::calc_default_denominator<C>( taps ) )
+	{
+	}
+
+protected:
+	/**
+	 * For derived filters with another tap set, that is used with the
+	 * summation order of this one. It has to stay valid as long as any
+	 * copy of the filter exists.
+	 */
+	DynamicFilter( unsigned taps_, const std::vector<C> & folded_coefficients_, C denominator )
+	: taps( check_taps( taps_ ) ),
+	  folded_coefficients( &folded_coefficients_ ),
+	  kernels( select_kernels( taps ) ),
+	  delay_line( taps ),
+	  window( taps + block_window_size ),
+	  normalizer( denominator )
+	{
+		if( folded_coefficients->size() != taps / 2 ) {
+			throw std::invalid_argument("Number of folded coefficients does not match the number of taps.");
+		}
+	}
+
+public:
+	unsigned get_taps() const {
+		return taps;
+	}
+
+	/**
+	 * true if this length has its own kernels
+	 */
+	bool is_specialized() const {
+		return kernels->taps != 0;
+	}
+
+	/**
+	 * add data without calculating
+	 */
+	void add( T input )
+	{
+		delay_line.push( input );
+		dirty = true;
+	}
+
+	/**
+	 * Calculates the sum and stores it.
+	 * If no data was added since the last calculation the stored sum is returned.
+	 */
+	C calculate()
+	{
+		if( dirty ) {
+			sum = kernels->window_sum( delay_line.window(), folded_coefficients->data(), taps );
+			dirty = false;
+		}
+
+		return sum;
+	}
+
+	/**
+	 * adds the new input value, calculates the filter and returns the devided result
+	 */
+	T operator()( T input )
+	{
+		add( input );
+		return get_result();
+	}
+
+	/**
+	 * Filters a whole block of samples.
+	 * out[k] gets exactly the value operator()( in[k] ) would have returned.
+	 */
+	void process( std::span<const T> in, std::span<T> out )
+	{
+		if( out.size() < in.size() ) {
+			throw std::invalid_argument("Output block is smaller than the input block.");
+		}
+
+		process_blocks( delay_line, taps, window, in, [&]( const T * w, size_t pos, size_t count ) {
+			std::array<C, block_window_size> sums;
+			kernels->block( w, folded_coefficients->data(), taps, sums.data(), count );
+
+			for( size_t k = 0; k < count; ++k ) {
+				out[pos + k] = normalizer( sums[k] );
+			}
+
+			sum = sums[count-1];
+		});
+
+		if( !in.empty() ) {
+			dirty = false;
+		}
+	}
+
+	/**
+	 * calculate and return the devided result
+	 * Calculates only, if data was added since the last calculation.
+	 */
+	T get_result() {
+		calculate();
+		return normalizer( sum );
+	}
+
+	/**
+	 * choose last sum and divide it
+	 */
+	T get_last_result() const {
+		return normalizer( sum );
+	}
+
+	C get_default_denominator() const {
+		return normalizer.get();
+	}
+
+	void set_default_denominator( C dd ) {
+		normalizer.set( dd );
+	}
+
+	/**
+	 * returns the full, unfolded tap set
+	 */
+	std::vector<C> get_coefficients() const
+	{
+		std::vector<C> coefficients( taps );
+
+		for( unsigned i = 0; i < taps / 2; ++i ) {
+			coefficients[taps-1-i] = (*folded_coefficients)[i];
+			coefficients[i] = (*folded_coefficients)[i] * -1;
+		}
+
+		return coefficients;
+	}
+
+	const std::vector<C> & get_folded_coefficients() const {
+		return *folded_coefficients;
+	}
+
+protected:
+	static unsigned check_taps( unsigned taps )
+	{
+		if( taps < 3 || taps % 2 == 0 ) {
+			throw std::invalid_argument("Number of taps has to be odd and at least 3.");
+		}
+
+		return taps;
+	}
+
+	/**
+	 * same summation order as Filter::calculate_window()
+	 */
+	template<unsigned N>
+	EXMATH_NO_FP_CONTRACT
+	static C fixed_window_sum( const T * x, const C * cf, unsigned )
+	{
+		if constexpr( has_simd_kernels && std::is_integral_v<C> ) {
+			return simd::folded_sum( x, cf, N );
+		}
+
+		C output = 0;
+
+		for( unsigned i = 0, j = N-1; i < N/2; ++i, --j ) {
+			output += cf[i] * ( C(x[j]) - C(x[i]) );
+		}
+
+		return output;
+	}
+
+	template<unsigned N>
+	static void fixed_block( const T * w, const C * cf, unsigned, C * sums, std::size_t count )
+	{
+		if constexpr( has_simd_kernels ) {
+			simd::folded_block_fixed<N>( w, cf, sums, count );
+		} else {
+			simd::scalar::folded_block( w, 1, cf, N, sums, count );
+		}
+	}
+
+	EXMATH_NO_FP_CONTRACT
+	static C generic_window_sum( const T * x, const C * cf, unsigned n )
+	{
+		if constexpr( has_simd_kernels && std::is_integral_v<C> ) {
+			return simd::folded_sum( x, cf, n );
+		}
+
+		C output = 0;
+
+		for( unsigned i = 0, j = n-1; i < n/2; ++i, --j ) {
+			output += cf[i] * ( C(x[j]) - C(x[i]) );
+		}
+
+		return output;
+	}
+
+	static void generic_block( const T * w, const C * cf, unsigned n, C * sums, std::size_t count )
+	{
+		if constexpr( has_simd_kernels ) {
+			simd::folded_block( w, cf, n, sums, count );
+		} else {
+			simd::scalar::folded_block( w, 1, cf, n, sums, count );
+		}
+	}
+
+	template<std::size_t... I>
+	static constexpr std::array<Kernels, sizeof...(I)> make_specialized_kernels( std::index_sequence<I...> )
+	{
+		return { Kernels{ specialized_taps[I],
+						  fixed_window_sum<specialized_taps[I]>,
+						  fixed_block<specialized_taps[I]> }... };
+	}
+
+	static const Kernels * select_kernels( unsigned taps )
+	{
+		static constexpr std::array<Kernels, specialized_taps.size()> specialized =
+			make_specialized_kernels( std::make_index_sequence<specialized_taps.size()>() );
+
+		static constexpr Kernels generic = { 0, generic_window_sum, generic_block };
+
+		for( const Kernels & k : specialized ) {
+			if( k.taps == taps ) {
+				return &k;
+			}
+		}
+
+		return &generic;
+	}
+};
+
+} // namespace exmath::Filter::SNRDFir
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include "SNRDFir.hpp"
+
+/*
+ * Compile time selection of the narrowest safe integer types for a SNRD filter.
+ *
+ * Like check_will_it_overflow() the worst case sum is calculated at compile
+ * time, but here it is used to pick the input storage type and the
+ * accumulator type. Narrower types mean more SIMD lanes.
+ *
+ * auto filter = Filter::SNRDFir::make_filter<13*2+1, 12>();   // 12 bit ADC
+ *
+ * NarrowestTypes<N,bits>::input_type and ::accumulator_type
+ * show what was chosen.
+ *
+ * The output has the same magnitude as the input at most, as long as the
+ * default denominator is not reduced by set_default_denominator().
+ */
+
+namespace exmath::Filter::SNRDFir {
+
+namespace internal {
+
+	typedef unsigned __int128 uint128;
+
+	/**
+	 * exact binomial coefficient, a compiler error when it doesn't fit into 128 bit
+	 */
+	constexpr uint128 binomial( unsigned n, unsigned k )
+	{
+		if( k > n ) {
+			return 0;
+		}
+
+		uint128 result = 1;
+
+		for( unsigned i = 0; i < k; ++i ) {
+			if( std::numeric_limits<uint128>::max() / ( n - i ) < result ) {
+				throw std::overflow_error("Overflow error. Binomial coefficient too large.");
+			}
+
+			// always divisible, the result is C(n,i+1)
+			result = result * ( n - i ) / ( i + 1 );
+		}
+
+		return result;
+	}
+
+	/**
+	 * Sum of the absolute SNRD coefficients.
+	 * The taps are C(N-3,k) - C(N-3,k-2), the sum of one half telescopes to
+	 * C(N-3,c-1) + C(N-3,c-2) = C(N-2,c-1), with c = (N-1)/2.
+	 */
+	template<unsigned N>
+	constexpr uint128 abs_coefficient_sum()
+	{
+		return 2 * binomial( N - 2, ( N - 3 ) / 2 );
+	}
+
+	template<typename C>
+	constexpr bool fits( uint128 value )
+	{
+		return value <= static_cast<uint128>( std::numeric_limits<C>::max() );
+	}
+
+} // namespace internal
+
+template <unsigned N, unsigned max_input_bits>
+requires internal::odds_only<unsigned, N>
+struct NarrowestTypes
+{
+	// the default denominator 2^(N-2) has to fit into int64_t
+	static_assert( N >= 5 && N <= 63, "Integer filters are only possible with 5 to 63 taps." );
+	static_assert( max_input_bits > 0 && max_input_bits < 63, "max_input_bits out of range." );
+
+	/**
+	 * |input| < 2^max_input_bits
+	 */
+	static constexpr internal::uint128 max_input = ( internal::uint128(1) << max_input_bits ) - 1;
+	static constexpr internal::uint128 max_sum = max_input * internal::abs_coefficient_sum<N>();
+
+	// the default denominator is 2^(N-2)
+	template<typename C>
+	static constexpr bool accumulator_fits =
+		internal::fits<C>( max_sum )
+		&& N - 2 < std::numeric_limits<C>::digits
+		&& internal::fits<C>( 2 * max_input );    // the folded difference
+
+	/**
+	 * At least 16 bit, the SIMD kernels widen int16_t, but not int8_t
+	 */
+	typedef std::conditional_t< max_input_bits <= 15, int16_t,
+			std::conditional_t< max_input_bits <= 31, int32_t, int64_t > > input_type;
+
+	typedef std::conditional_t< accumulator_fits<int32_t>, int32_t,
+			std::conditional_t< accumulator_fits<int64_t>, int64_t, void > > accumulator_type;
+
+	static_assert( !std::is_void_v<accumulator_type>,
+				   "No integer accumulator can hold this filter without an overflow. int32_t takes up to 31 taps, "
+				   "int64_t up to 63, if the worst case sum of max_input_bits inputs fits as well." );
+
+	typedef Filter<input_type, accumulator_type, N> filter_type;
+
+	static constexpr unsigned input_bits = sizeof(input_type) * 8;
+	static constexpr unsigned accumulator_bits = sizeof(accumulator_type) * 8;
+};
+
+/**
+ * returns a filter with the narrowest types, that can't overflow
+ * with inputs of max_input_bits
+ */
+template <unsigned N, unsigned max_input_bits>
+typename NarrowestTypes<N, max_input_bits>::filter_type make_filter()
+{
+	return {};
+}
+
+} // namespace exmath::Filter::SNRDFir
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include "SNRDFir.hpp"
+#include "SimdKernels.hpp"
+
+/*
+ * Bank of SNRD differentiators for many channels, sharing one coefficient set.
+ *
+ * The histories are stored as structure of arrays: one row with the samples
+ * of all channels per point in time. So every coefficient is applied to
+ * all channels at once with SIMD, and the rows are read sequentially.
+ *
+ * Input and output are interleaved frames: ch0, ch1, ... chN-1 per sample.
+ *
+ * Filter::SNRDFir::FilterBank<int32_t,int32_t,11,64> bank;
+ *
+ * bank.process( adc_frames, result_frames );
+ *
+ * The results are bit identical to one Filter<T,C,N> per channel.
+ */
+
+namespace exmath::Filter::SNRDFir {
+
+template <typename T, typename C, unsigned N, unsigned Channels>
+requires internal::odds_only<unsigned, N> && ( Channels > 0 )
+class FilterBank
+{
+protected:
+	/**
+	 * N rows of Channels samples. Every row is stored twice (at index and index + N),
+	 * so the last N rows are always contiguous, starting at row index.
+	 */
+	std::array<T, 2 * N * Channels> history{};
+	std::array<C, Channels> sums{};
+	static constexpr std::array<C, N/2> folded_coefficients = Filter<T,C,N>::calc_folded_coefficients();
+
+	unsigned index = 0;
+	internal::Normalizer<C> normalizer{ Filter<T,C,N>::calc_default_denominator() };
+
+public:
+	/**
+	 * adds one frame (one sample per channel) without calculating
+	 */
+	void add( std::span<const T> frame )
+	{
+		if( frame.size() != Channels ) {
+			throw std::invalid_argument("Frame size does not match the number of channels.");
+		}
+
+		std::copy( frame.begin(), frame.end(), history.begin() + index * Channels );
+		std::copy( frame.begin(), frame.end(), history.begin() + ( index + N ) * Channels );
+		if( ++index == N ) {
+			index = 0;
+		}
+	}
+
+	/**
+	 * calculates the sums of all channels and stores them
+	 */
+	void calculate()
+	{
+		const T * window = &history[index * Channels];
+
+		if constexpr( simd::supported_pair<T,C> ) {
+			simd::folded_block( window, Channels, folded_coefficients.data(), N, sums.data(), Channels );
+		} else {
+			simd::scalar::folded_block( window, Channels, folded_coefficients.data(), N, sums.data(), Channels );
+		}
+	}
+
+	/**
+	 * Filters interleaved frames, in.size() has to be a multiple of Channels.
+	 */
+	void process( std::span<const T> in, std::span<T> out )
+	{
+		if( in.size() % Channels != 0 ) {
+			throw std::invalid_argument("Input is not a multiple of the frame size.");
+		}
+
+		if( out.size() < in.size() ) {
+			throw std::invalid_argument("Output block is smaller than the input block.");
+		}
+
+		for( size_t pos = 0; pos < in.size(); pos += Channels ) {
+			add( in.subspan( pos, Channels ) );
+			calculate();
+
+			for( unsigned ch = 0; ch < Channels; ++ch ) {
+				out[pos + ch] = normalizer( sums[ch] );
+			}
+		}
+	}
+
+	/**
+	 * returns the last calculated and devided result of one channel
+	 */
+	T get_last_result( unsigned channel ) const {
+		return normalizer( sums.at(channel) );
+	}
+
+	const std::array<C, Channels> & get_sums() const {
+		return sums;
+	}
+
+	C get_default_denominator() const {
+		return normalizer.get();
+	}
+
+	void set_default_denominator( C dd ) {
+		normalizer.set( dd );
+	}
+
+	static constexpr unsigned get_channels() {
+		return Channels;
+	}
+};
+
+} // namespace exmath::Filter::SNRDFir
@@ -1,9 +1,17 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cmath>
 #include <limits>
+#include <span>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
+#include "DelayLine.hpp"
+#include "SimdKernels.hpp"
+#include "catalans_triangle.h"
 
 /*
  * Smooth Noise Robust Differentiators Fir Filter
@@ -20,82 +28,281 @@
  *
  * current_result = filter.get_result();
  *
+ * or for a whole block of samples at once:
+ *
+ * filter.process( adc_block, result_block );
+ *
  */
 
 namespace exmath::Filter::SNRDFir {
 
 namespace internal {
 
-	template<typename T, unsigned n>
-	constexpr std::array<T,n> calc_last_line_of_catalan_triangle();
-
 	/*
 	template<unsigned N> constexpr int square() { return N * N; }
 	template<unsigned N> constexpr bool isodd() { return N % 2 ==1; }
 	*/
-	template<unsigned N> struct is_odd { static const bool value = is_odd<N-2>::value; };
+	template<unsigned N> struct is_odd { static const bool value = N % 2 == 1; };
 
 	template<unsigned N> constexpr bool is_odd_v = is_odd<N>::value;
 
-	template<> struct is_odd<1> { static const bool value = true; };
-
-	template<> struct is_odd<0> { static const bool value = false; };
-
 	template<typename T, T N>
 	concept odds_only =
 	    std::is_integral_v<T>
 	    && is_odd_v<N>;
 
+	/**
+	 * Divides the sum by the denominator, without a division where possible.
+	 *
+	 * The default denominator is always a power of two. For integer types
+	 * the division is done by an arithmetic shift then, rounded towards zero
+	 * like the division. For floating point types the sum is multiplied by
+	 * the exact inverse. So the results are the same as with a division.
+	 * Any other denominator falls back to the division.
+	 */
+	template<typename C>
+	class Normalizer
+	{
+		C   denominator = 1;
+		int shift = -1;           // integer types: log2( denominator ), -1 if not a power of two
+		C   inverse = 0;          // floating point types: 1 / denominator or the factor, 0 if not exact
+
+	public:
+		explicit Normalizer( C denominator_ ) {
+			set( denominator_ );
+		}
+
+		void set( C denominator_ )
+		{
+			denominator = denominator_;
+			shift = -1;
+			inverse = 0;
+
+			if constexpr( std::is_integral_v<C> ) {
+				typedef std::make_unsigned_t<C> U;
+
+				if( denominator > 0 && std::has_single_bit( static_cast<U>( denominator ) ) ) {
+					shift = std::countr_zero( static_cast<U>( denominator ) );
+				}
+			} else {
+				int exp = 0;
+
+				if( std::frexp( denominator, &exp ) == C(0.5) ) {
+					const C inv = C(1) / denominator;
+
+					// 1 / denominator has to be a normal number to be exact
+					if( inv >= std::numeric_limits<C>::min() && std::isfinite( inv ) ) {
+						inverse = inv;
+					}
+				}
+			}
+		}
+
+		/**
+		 * floating point types: multiplies the sum by factor,
+		 * which doesn't have to be the exact inverse of a power of two
+		 */
+		void set_factor( C factor ) requires std::is_floating_point_v<C>
+		{
+			denominator = C(1) / factor;
+			shift = -1;
+			inverse = factor;
+		}
+
+		C get() const {
+			return denominator;
+		}
+
+		C operator()( C sum ) const
+		{
+			if constexpr( std::is_integral_v<C> ) {
+				if( shift >= 0 ) {
+					if constexpr( std::is_signed_v<C> ) {
+						// the shift rounds towards -inf, the division towards zero
+						const C bias = sum < 0 ? static_cast<C>( ( C(1) << shift ) - 1 ) : C(0);
+						return ( sum + bias ) >> shift;
+					} else {
+						return sum >> shift;
+					}
+				}
+			} else {
+				if( inverse != 0 ) {
+					return sum * inverse;
+				}
+			}
+
+			return sum / denominator;
+		}
+	};
+
+	/**
+	 * 2^(taps-2), the default denominator of Filter<T,C,taps>, for a taps only known at runtime
+	 */
+	template<typename C>
+	constexpr C calc_default_denominator( unsigned taps )
+	{
+		C denominator = 1;
+
+		for( unsigned i = 2; i < taps; ++i ) {
+			if( std::numeric_limits<C>::max() / 2 < denominator ) {
+				throw std::overflow_error("Overflow error. Multiplication not possible with this datatype.");
+			}
+
+			denominator *= 2;
+		}
+
+		return denominator;
+	}
+
+	template<typename C, unsigned N>
+	constexpr std::array<C, N> calc_coefficients()
+	{
+		std::array<C, N> coefficients{};
+		constexpr auto catalans_triangle = calc_last_line_of_catalan_triangle<C,N/2>();
+
+		// fill reverse and negative
+		unsigned i = 0;
+		for( auto it = catalans_triangle.rbegin(); it < catalans_triangle.rend(); ++it, ++i ) {
+			coefficients[i] = *it * -1;
+		}
+
+		// the middle one is unused
+		coefficients[i] = 0;
+		++i;
+
+		for( auto it = catalans_triangle.begin(); it < catalans_triangle.end(); ++it, ++i ) {
+			coefficients[i] = *it;
+		}
+
+		return coefficients;
+	}
+
+	template<typename C, unsigned N>
+	constexpr std::array<C, N/2> calc_folded_coefficients()
+	{
+		std::array<C, N/2> folded{};
+		constexpr std::array<C, N> coefficients = calc_coefficients<C,N>();
+
+		for( unsigned i = 0; i < N/2; ++i ) {
+			folded[i] = coefficients[N-1-i];
+		}
+
+		return folded;
+	}
+
+	/**
+	 * Default storage of the folded taps: one static constexpr table
+	 * per type, shared by all instances and placed in read only memory
+	 * (flash on MCUs). An instance does not contain any copy.
+	 */
+	template<typename C, unsigned N>
+	struct SharedCoefficients
+	{
+		static constexpr std::array<C, N/2> values = calc_folded_coefficients<C,N>();
+
+		const std::array<C, N/2> & get() const {
+			return values;
+		}
+
+		const C * data() const {
+			return values.data();
+		}
+
+		C operator[]( unsigned i ) const {
+			return values[i];
+		}
+	};
+
+	/**
+	 * Per instance copy of the folded taps, for filters that
+	 * modify their taps, like NormalizedFilter.
+	 */
+	template<typename C, unsigned N>
+	struct InstanceCoefficients
+	{
+		std::array<C, N/2> values = calc_folded_coefficients<C,N>();
+
+		const std::array<C, N/2> & get() const {
+			return values;
+		}
+
+		const C * data() const {
+			return values.data();
+		}
+
+		C operator[]( unsigned i ) const {
+			return values[i];
+		}
+	};
 
 } // namespace internal
 
-template <typename T, typename C, unsigned N>
-requires internal::odds_only<unsigned, N>
+template <typename T, typename C, unsigned N,
+		  class Coefficients = internal::SharedCoefficients<C,N>,
+		  class DelayLine = MirroredDelayLine<T,N>>
+requires internal::odds_only<unsigned, N> && delay_line_policy<DelayLine, T> && ( DelayLine::size == N )
 class Filter
 {
 protected:
-	std::array<T, N> input_buffer{};   // Input buffer
-	std::array<C, N> coefficients = calc_coefficients();
+	/**
+	 * The last N input samples. Mirrored by default, so they are
+	 * always contiguous, see DelayLine.hpp for the other policies.
+	 */
+	DelayLine delay_line;
+	/**
+	 * The tap set is antisymmetric: coefficients[N-1-i] == -coefficients[i]
+	 * and the center tap is 0. So only the N/2 positive ones are used,
+	 * outermost (smallest) first. Shared by default, so it takes no space.
+	 */
+	[[no_unique_address]] Coefficients folded_coefficients;
 
     C       sum = 0;
-    int     index = 0;
-    C       default_denominator = calc_default_denominator();
+    internal::Normalizer<C> normalizer{ calc_default_denominator() };
+    bool    dirty = true;                 // sum does not match the delay line
+    unsigned decimation_phase = 0;        // inputs since the last decimated output
 
 public:
+	/**
+	 * number of taps, the output depends on the last taps input samples
+	 */
+	static constexpr unsigned taps = N;
+
+	/**
+	 * number of samples process() linearizes at once
+	 */
+	static constexpr unsigned block_window_size = 256;
+
+	/**
+	 * Filters up to this length sum the taps fully unrolled, with the
+	 * coefficients as immediate constants, if they are shared.
+	 */
+	static constexpr unsigned unroll_threshold = 31;
+
 	/**
 	 * add data without calculating
 	 */
 	void add(T input)
 	{
-		input_buffer[index] = input;
-		index = (index + 1) % N;
+		delay_line.push( input );
+		dirty = true;
 	}
 
 	/**
 	 * Calculates the sum and stores it.
+	 * If no data was added since the last calculation the stored sum is returned.
 	 */
 	C calculate()
 	{
-		C output = 0;
-
-		/* default way to straight to accumulate
-			for (int i = 0; i < N; i++) {
-				output += coefficients[i] * input_buffer[(index + i) % N];
+		if( dirty ) {
+			if constexpr( DelayLine::contiguous ) {
+				sum = calculate_window( delay_line.window() );
+			} else {
+				sum = calculate_window( delay_line );
 			}
-		*/
 
-		/**
-		 * from outside to inside, to get accumulate data with increasing from low to high
-		 * Will only matter, if you are using realy small data and float, or double as T.
-		 * The center number is unused.
-		 */
-		for (int i = 0, j = N-1; i < N/2; i++, --j ) {
-			output += coefficients[i] * input_buffer[(index + i) % N];
-			output += coefficients[j] * input_buffer[(index + j) % N];
+			dirty = false;
 		}
 
-		sum = output;
-
 		return sum;
 	}
 
@@ -105,35 +312,124 @@ public:
 	T operator()( T input )
 	{
 		add( input );
-		calculate();
 		return get_result();
 	}
 
+	/**
+	 * Filters a whole block of samples.
+	 * out[k] gets exactly the value operator()( in[k] ) would have returned.
+	 *
+	 * The delay line is copied once into a contiguous history+block window,
+	 * so the inner loop needs no ring index wrap and can be vectorized.
+	 * Afterwards the filter state is the same as after feeding the samples
+	 * one by one.
+	 */
+	void process( std::span<const T> in, std::span<T> out )
+	{
+		if( out.size() < in.size() ) {
+			throw std::invalid_argument("Output block is smaller than the input block.");
+		}
+
+		std::array<T, N + block_window_size> window;
+
+		process_blocks( delay_line, N, window, in, [&]( const T * w, size_t pos, size_t count ) {
+			if constexpr( has_simd_kernels ) {
+				// one output per vector lane, bit identical to the scalar loop
+				std::array<C, block_window_size> sums;
+				simd::folded_block( w, folded_coefficients.data(), N, sums.data(), count );
+
+				for( size_t k = 0; k < count; ++k ) {
+					out[pos + k] = normalizer( sums[k] );
+				}
+
+				sum = sums[count-1];
+			} else {
+				for( size_t k = 0; k < count; ++k ) {
+					sum = calculate_window( w + k );
+					out[pos + k] = normalizer( sum );
+				}
+			}
+		});
+
+		if( !in.empty() ) {
+			dirty = false;
+		}
+	}
+
+	/**
+	 * Decimating block filter: emits only every factor-th output,
+	 * the other samples just go into the delay line.
+	 * The phase is kept between calls, so the blocks can have any size.
+	 *
+	 * Returns the number of outputs written.
+	 */
+	size_t process_decimated( std::span<const T> in, std::span<T> out, unsigned factor )
+	{
+		if( factor == 0 ) {
+			throw std::invalid_argument("Decimation factor has to be at least 1.");
+		}
+
+		if( out.size() < ( decimation_phase + in.size() ) / factor ) {
+			throw std::invalid_argument("Output block is too small for this decimation factor.");
+		}
+
+		std::array<T, N + block_window_size> window;
+
+		size_t written = 0;
+
+		process_blocks( delay_line, N, window, in, [&]( const T * w, size_t, size_t count ) {
+			for( size_t k = 0; k < count; ++k ) {
+				if( ++decimation_phase < factor ) {
+					continue;
+				}
+
+				decimation_phase = 0;
+				sum = calculate_window( w + k );
+				out[written++] = normalizer( sum );
+			}
+		});
+
+		if( !in.empty() ) {
+			// the stored sum only matches the buffer, if the last sample was an output
+			dirty = decimation_phase != 0;
+		}
+
+		return written;
+	}
+
 	/**
 	 * calculate and return the devided result
+	 * Calculates only, if data was added since the last calculation.
 	 */
 	T get_result() {
 		calculate();
-		return sum / default_denominator;
+		return normalizer( sum );
 	}
 
 	/**
 	 * choose last sum and divide it
 	 */
 	T get_last_result() const {
-		return sum / default_denominator;
+		return normalizer( sum );
 	}
 
 	C get_default_denominator() const {
-		return default_denominator;
+		return normalizer.get();
 	}
 
 	void set_default_denominator( C dd ) {
-		default_denominator = dd;
+		normalizer.set( dd );
 	}
 
-	const std::array<C, N> & get_coefficients() const {
-		return coefficients;
+	/**
+	 * returns the full, unfolded tap set
+	 */
+	static constexpr std::array<C, N> get_coefficients() {
+		return calc_coefficients();
+	}
+
+	const std::array<C, N/2> & get_folded_coefficients() const {
+		return folded_coefficients.get();
 	}
 
 	/**
@@ -173,26 +469,103 @@ public:
 	}
 
 private:
-	static constexpr std::array<C, N> calc_coefficients()
+	static constexpr bool has_simd_kernels = simd::supported_pair<T,C>;
+
+	/**
+	 * Only shared taps are compile time constants, a per instance copy
+	 * (like the one of NormalizedFilter) is summed by the loop.
+	 */
+	static constexpr bool unrolled = N <= unroll_threshold
+		&& std::is_same_v<Coefficients, internal::SharedCoefficients<C,N>>;
+
+	/**
+	 * Calculates the sum of a window of N samples, oldest first.
+	 * Window is a pointer to contiguous samples, or a delay line
+	 * that can only be indexed.
+	 */
+	template<class Window>
+	C calculate_window( const Window & x ) const
 	{
-		std::array<C, N> coefficients{};
-		constexpr auto catalans_triangle = internal::calc_last_line_of_catalan_triangle<T,N/2>();
+		if constexpr( std::is_floating_point_v<C> ) {
+			return calculate_window_uncontracted( x );
+		} else {
+			return sum_window( x );
+		}
+	}
 
-		// fill reverse and negative
-		unsigned i = 0;
-		for( auto it = catalans_triangle.rbegin(); it < catalans_triangle.rend(); ++it, ++i ) {
-			coefficients[i] = *it * -1;
+	/**
+	 * Without fused multiply adds, so float and double round like the
+	 * block kernels. Not inlined into the callers then, which is why
+	 * integer types don't take this way.
+	 */
+	template<class Window>
+	EXMATH_NO_FP_CONTRACT
+	C calculate_window_uncontracted( const Window & x ) const
+	{
+		return sum_window( x );
+	}
+
+	template<class Window>
+	[[gnu::always_inline]] C sum_window( const Window & x ) const
+	{
+		if constexpr( unrolled ) {
+			// no loop and no dispatch, for small filters both cost more than the taps
+			return calculate_window_unrolled( x, std::make_index_sequence<N/2>() );
 		}
 
-		// the middle one is unused
-		coefficients[i] = 0;
-		++i;
+		if constexpr( has_simd_kernels && std::is_integral_v<C> && std::is_pointer_v<Window> ) {
+			// summation order does not matter for integers
+			return simd::folded_sum( x, folded_coefficients.data(), N );
+		}
 
-		for( auto it = catalans_triangle.begin(); it < catalans_triangle.end(); ++it, ++i ) {
-			coefficients[i] = *it;
+		C output = 0;
+
+		/* default way to straight to accumulate
+			for (int i = 0; i < N; i++) {
+				output += coefficients[i] * x[i];
+			}
+		*/
+
+		/**
+		 * from outside to inside, to get accumulate data with increasing from low to high
+		 * Will only matter, if you are using realy small data and float, or double as T.
+		 * The center number is unused.
+		 *
+		 * Folded: c[j] * x[j] + c[i] * x[i] == c[j] * ( x[j] - x[i] ),
+		 * so only N/2 multiplications are required.
+		 */
+		for( unsigned i = 0, j = N-1; i < N/2; ++i, --j ) {
+			output += folded_coefficients[i] * ( C(x[j]) - C(x[i]) );
 		}
 
-		return coefficients;
+		return output;
+	}
+
+	/**
+	 * the loop of sum_window() unrolled, same summation order
+	 */
+	template<class Window, std::size_t... I>
+	[[gnu::always_inline]] static C calculate_window_unrolled( const Window & x, std::index_sequence<I...> )
+	{
+		C output = 0;
+
+		( ( output += Coefficients::values[I] * ( C(x[N-1-I]) - C(x[I]) ) ), ... );
+
+		return output;
+	}
+
+	static constexpr std::array<C, N> calc_coefficients()
+	{
+		return internal::calc_coefficients<C,N>();
+	}
+
+public:
+	/*
+	 * also used by the other SNRD engines, which share the tap set
+	 */
+	static constexpr std::array<C, N/2> calc_folded_coefficients()
+	{
+		return internal::calc_folded_coefficients<C,N>();
 	}
 
 	static constexpr C calc_default_denominator()
@@ -221,69 +594,4 @@ public:
 	}
 };
 
-namespace internal {
-
-/*
- * Calcualates the last line of the catalan triangle
- * https://oeis.org/A039598
- * https://oeis.org/A039598/b039598.txt
- *
- * (Sage)
- *  D = [0]*(n+2); D[1] = 1
- *  b = True; h = 1
- *  for i in range(2*n) :
- *      if b :
- *        for k in range(h, 0, -1) : D[k] += D[k-1]
- *          h += 1
- *      else :
- *          for k in range(1, h, 1) : D[k] += D[k+1]
- *      b = not b
- *      if b : print([D[z] for z in (1..h-1) ])
- */
-
-template<typename T, unsigned n>
-constexpr std::array<T,n> calc_last_line_of_catalan_triangle()
-{
-  std::array<T,n+2> D{0};
-
-  bool b = true;
-  int h = 1;
-  D.at(1) = 1;
-
-  for( int i = 0; i < 2 * int(n); ++i ) {
-	if( b ) {
-	  for( int k = h; k > 0; --k ) {
-
-		if( std::numeric_limits<T>::max() - D.at(k-1) < D.at(k) ) {
-		  throw std::overflow_error("Overflow error. Coefficient not possible with this datatype.");
-		}
-
-		D.at(k) += D.at(k-1);
-	  }
-	  h += 1;
-	} else {
-	  for( int k = 1; k < h; ++k ) {
-
-		if( std::numeric_limits<T>::max() - D.at(k+1) < D.at(k) ) {
-		  throw std::overflow_error("Overflow error. Coefficient not possible with this datatype.");
-		}
-
-		D.at(k) += D.at(k+1);
-	  }
-	}
-
-	b = !b;
-  }
-
-  std::array<T,n> ret{0};
-
-  for( int z = 1,i = 0; z < h; ++z, ++i ) {
-	ret.at(i) = D.at(z);
-  }
-
-  return ret;
-}
-
-} // namespace internal
-
 } // namespace Filter::SNRD
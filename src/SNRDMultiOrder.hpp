@@ -0,0 +1,328 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include "SNRDFir.hpp"
+
+/*
+ * Smoothed value, first and second derivative of the same signal
+ * from one shared delay line.
+ *
+ * All three tap sets are built from binomial coefficients:
+ *
+ *   smoothing          ( 1 + z^-1 )^(N-1)                    / 2^(N-1)
+ *   first derivative   ( 1 - z^-2 ) ( 1 + z^-1 )^(N-3)       / 2^(N-2)   (the SNRD taps)
+ *   second derivative  ( 1 - z^-2 )^2 ( 1 + z^-1 )^(N-5)     / 2^(N-3)
+ *
+ * The smoothing and the second derivative taps are symmetric, the first
+ * derivative taps antisymmetric. So for every pair of samples x[i], x[N-1-i]
+ * the sum and the difference are built once and feed all three outputs.
+ * The history is walked once instead of three times.
+ *
+ * All three outputs refer to the center of the window, they are
+ * delayed by (N-1)/2 samples.
+ *
+ * Filter::SNRDFir::MultiOrderFilter<double,double,27*2+1> filter;
+ *
+ * while( ... ) {
+ *   auto r = filter( sensor_value );
+ *   position = r.smoothed; velocity = r.first_derivative; acceleration = r.second_derivative;
+ * }
+ */
+
+namespace exmath::Filter::SNRDFir {
+
+namespace internal {
+
+	/**
+	 * wide enough for C(n-1,k) times a factor below 2^32
+	 */
+	template<unsigned n>
+	using BinomialInt = BigUInt<( n + 32 ) / 64 + 1>;
+
+	/**
+	 * the exact coefficients of ( 1 + z^-1 )^(n-1)
+	 */
+	template<unsigned n>
+	constexpr std::array<BinomialInt<n>,n> calc_exact_binomial_line()
+	{
+		std::array<BinomialInt<n>,n> line{};
+		line[0] = 1;
+
+		for( unsigned k = 1; k < n; ++k ) {
+			line[k] = line[k-1];
+			line[k] *= n - k;
+			line[k] /= k;
+		}
+
+		return line;
+	}
+
+	/**
+	 * the coefficients of ( 1 + z^-1 )^(n-1), pascal's triangle line n.
+	 * Calculated exactly and rounded once, like the catalan line.
+	 */
+	template<typename C, unsigned n>
+	constexpr std::array<C,n> calc_binomial_line()
+	{
+		const std::array<BinomialInt<n>,n> exact = calc_exact_binomial_line<n>();
+		std::array<C,n> line{};
+
+		for( unsigned k = 0; k < n; ++k ) {
+			line[k] = exact[k].template to<C>();
+		}
+
+		return line;
+	}
+
+} // namespace internal
+
+template <typename T, typename C, unsigned N>
+requires internal::odds_only<unsigned, N> && ( N >= 5 )
+class MultiOrderFilter
+{
+public:
+	enum Output
+	{
+		SMOOTHED = 0,
+		FIRST_DERIVATIVE,
+		SECOND_DERIVATIVE,
+		OUTPUT_COUNT
+	};
+
+	struct Result
+	{
+		T smoothed;
+		T first_derivative;
+		T second_derivative;
+	};
+
+protected:
+	/**
+	 * mirrored like in Filter, the last N samples are always contiguous
+	 */
+	MirroredDelayLine<T, N> delay_line;
+
+	static constexpr std::array<C, N/2+1> fold_symmetric( const std::array<C, N> & coefficients )
+	{
+		std::array<C, N/2+1> folded{};
+		std::copy_n( coefficients.begin(), N/2+1, folded.begin() );
+		return folded;
+	}
+
+	std::array<C, OUTPUT_COUNT> sums{};
+	bool    dirty = true;
+
+	std::array<internal::Normalizer<C>, OUTPUT_COUNT> normalizers = {
+		internal::Normalizer<C>( calc_default_denominator( SMOOTHED ) ),
+		internal::Normalizer<C>( calc_default_denominator( FIRST_DERIVATIVE ) ),
+		internal::Normalizer<C>( calc_default_denominator( SECOND_DERIVATIVE ) )
+	};
+
+public:
+	static constexpr unsigned taps = N;
+
+	/**
+	 * number of samples process() linearizes at once
+	 */
+	static constexpr unsigned block_window_size = 256;
+
+	static constexpr bool has_simd_kernels = simd::supported_pair<T,C>;
+
+	/**
+	 * add data without calculating
+	 */
+	void add( T input )
+	{
+		delay_line.push( input );
+		dirty = true;
+	}
+
+	/**
+	 * Calculates all three sums and stores them.
+	 * If no data was added since the last calculation the stored sums are returned.
+	 */
+	const std::array<C, OUTPUT_COUNT> & calculate()
+	{
+		if( dirty ) {
+			calculate_windows( delay_line.window(), &sums[SMOOTHED], &sums[FIRST_DERIVATIVE], &sums[SECOND_DERIVATIVE], 1 );
+			dirty = false;
+		}
+
+		return sums;
+	}
+
+	/**
+	 * adds the new input value and returns all three divided results
+	 */
+	Result operator()( T input )
+	{
+		add( input );
+		return get_result();
+	}
+
+	/**
+	 * Filters a whole block of samples into three output blocks.
+	 * The k-th outputs get exactly the values operator()( in[k] ) would have returned.
+	 */
+	void process( std::span<const T> in,
+				  std::span<T> smoothed,
+				  std::span<T> first_derivative,
+				  std::span<T> second_derivative )
+	{
+		if( smoothed.size() < in.size() ||
+			first_derivative.size() < in.size() ||
+			second_derivative.size() < in.size() ) {
+			throw std::invalid_argument("Output block is smaller than the input block.");
+		}
+
+		std::array<T, N + block_window_size> window;
+		std::array<std::array<C, block_window_size>, OUTPUT_COUNT> block_sums;
+
+		process_blocks( delay_line, N, window, in, [&]( const T * w, size_t pos, size_t count ) {
+			calculate_windows( w,
+							   block_sums[SMOOTHED].data(),
+							   block_sums[FIRST_DERIVATIVE].data(),
+							   block_sums[SECOND_DERIVATIVE].data(),
+							   count );
+
+			for( size_t k = 0; k < count; ++k ) {
+				smoothed[pos + k]          = normalizers[SMOOTHED]( block_sums[SMOOTHED][k] );
+				first_derivative[pos + k]  = normalizers[FIRST_DERIVATIVE]( block_sums[FIRST_DERIVATIVE][k] );
+				second_derivative[pos + k] = normalizers[SECOND_DERIVATIVE]( block_sums[SECOND_DERIVATIVE][k] );
+			}
+
+			for( unsigned o = 0; o < OUTPUT_COUNT; ++o ) {
+				sums[o] = block_sums[o][count-1];
+			}
+		});
+
+		if( !in.empty() ) {
+			dirty = false;
+		}
+	}
+
+	Result get_result()
+	{
+		calculate();
+		return get_last_result();
+	}
+
+	Result get_last_result() const
+	{
+		return Result{
+			static_cast<T>( normalizers[SMOOTHED]( sums[SMOOTHED] ) ),
+			static_cast<T>( normalizers[FIRST_DERIVATIVE]( sums[FIRST_DERIVATIVE] ) ),
+			static_cast<T>( normalizers[SECOND_DERIVATIVE]( sums[SECOND_DERIVATIVE] ) )
+		};
+	}
+
+	C get_default_denominator( Output output ) const {
+		return normalizers.at( output ).get();
+	}
+
+	void set_default_denominator( Output output, C dd ) {
+		normalizers.at( output ).set( dd );
+	}
+
+	/**
+	 * ( 1 + z^-1 )^(N-1)
+	 */
+	static constexpr std::array<C, N> get_smoothing_coefficients() {
+		return internal::calc_binomial_line<C,N>();
+	}
+
+	/**
+	 * the SNRD taps of Filter<T,C,N>
+	 */
+	static constexpr std::array<C, N> get_first_derivative_coefficients() {
+		return Filter<T,C,N>::get_coefficients();
+	}
+
+	/**
+	 * ( 1 - 2 z^-2 + z^-4 ) ( 1 + z^-1 )^(N-5)
+	 */
+	static constexpr std::array<C, N> get_second_derivative_coefficients()
+	{
+		typedef internal::BinomialInt<N-4> Int;
+
+		const std::array<Int, N-4> binomial = internal::calc_exact_binomial_line<N-4>();
+		std::array<C, N> coefficients{};
+
+		// summed exactly and rounded once
+		for( unsigned k = 0; k < N; ++k ) {
+			Int positive = 0;
+			Int negative = 0;
+
+			if( k < N-4 ) {
+				positive += binomial[k];
+			}
+
+			if( k >= 4 ) {
+				positive += binomial[k-4];
+			}
+
+			if( k >= 2 && k-2 < N-4 ) {
+				negative = binomial[k-2];
+				negative *= 2;
+			}
+
+			if( negative < positive ) {
+				positive -= negative;
+				coefficients[k] = positive.template to<C>();
+			} else {
+				negative -= positive;
+				coefficients[k] = negative.template to<C>() * -1;
+			}
+		}
+
+		return coefficients;
+	}
+
+	static constexpr C calc_default_denominator( Output output )
+	{
+		switch( output ) {
+		case SMOOTHED:          return Filter<T,C,N>::template ipow<C>( 2, N-1 );
+		case FIRST_DERIVATIVE:  return Filter<T,C,N>::calc_default_denominator();
+		case SECOND_DERIVATIVE: return Filter<T,C,N>::template ipow<C>( 2, N-3 );
+		default:                break;
+		}
+
+		throw std::invalid_argument("Invalid output.");
+	}
+
+protected:
+	/**
+	 * The symmetric sets store the outer half and the center tap,
+	 * outermost first. The antisymmetric set is the one of Filter.
+	 * Shared by all instances.
+	 */
+	static constexpr std::array<C, N/2+1> smoothing_coefficients = fold_symmetric( get_smoothing_coefficients() );
+	static constexpr std::array<C, N/2>   first_derivative_coefficients = Filter<T,C,N>::calc_folded_coefficients();
+	static constexpr std::array<C, N/2+1> second_derivative_coefficients = fold_symmetric( get_second_derivative_coefficients() );
+
+	/**
+	 * count consecutive windows starting at w, the sums are not divided
+	 */
+	void calculate_windows( const T * w, C * s0, C * s1, C * s2, std::size_t count ) const
+	{
+		if constexpr( has_simd_kernels ) {
+			simd::fused_block( w,
+							   smoothing_coefficients.data(),
+							   first_derivative_coefficients.data(),
+							   second_derivative_coefficients.data(),
+							   N, s0, s1, s2, count );
+		} else {
+			simd::scalar::fused_block( w,
+									   smoothing_coefficients.data(),
+									   first_derivative_coefficients.data(),
+									   second_derivative_coefficients.data(),
+									   N, s0, s1, s2, count );
+		}
+	}
+};
+
+} // namespace exmath::Filter::SNRDFir
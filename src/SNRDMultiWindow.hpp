@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include "SNRDFir.hpp"
+
+/*
+ * SNRD differentiators of several lengths on the same signal.
+ *
+ * One delay line sized for the longest window holds the history, every
+ * window uses the newest N of its samples. Window k pairs x[i] with
+ * x[N_k-1-i] counted from its own start, so the newer sample of each pair
+ * is the same for all windows. It is loaded once and shared.
+ *
+ * The results of window k are exactly the ones of Filter<T,C,N_k>.
+ *
+ * Filter::SNRDFir::MultiWindowFilter<double,double,11,27,55,127> filter;
+ *
+ * while( ... ) {
+ *   auto r = filter( sensor_value );
+ *   // r[0] from N=11 ... r[3] from N=127
+ * }
+ */
+
+namespace exmath::Filter::SNRDFir {
+
+template <typename T, typename C, unsigned... Ns>
+requires ( sizeof...(Ns) > 0 ) && ( internal::odds_only<unsigned, Ns> && ... )
+class MultiWindowFilter
+{
+public:
+	static constexpr unsigned windows = sizeof...(Ns);
+	static constexpr std::array<unsigned, windows> window_sizes = { Ns... };
+	static constexpr unsigned taps = std::max( { Ns... } );
+
+	/**
+	 * number of samples process() linearizes at once
+	 */
+	static constexpr unsigned block_window_size = 256;
+
+	static constexpr bool has_simd_kernels = simd::supported_pair<T,C>;
+
+protected:
+	typedef std::make_index_sequence<windows> window_indices;
+
+	/**
+	 * the folded taps of every window, shared by all instances
+	 */
+	static constexpr std::tuple<std::array<C, Ns/2>...> folded_coefficients = {
+		Filter<T,C,Ns>::calc_folded_coefficients()...
+	};
+
+	/**
+	 * mirrored like in Filter, the last taps samples are always contiguous
+	 */
+	MirroredDelayLine<T, taps> delay_line;
+
+	std::array<C, windows> sums{};
+	bool    dirty = true;
+
+	std::array<internal::Normalizer<C>, windows> normalizers = {
+		internal::Normalizer<C>( Filter<T,C,Ns>::calc_default_denominator() )...
+	};
+
+public:
+	/**
+	 * add data without calculating
+	 */
+	void add( T input )
+	{
+		delay_line.push( input );
+		dirty = true;
+	}
+
+	/**
+	 * Calculates the sums of all windows and stores them.
+	 * If no data was added since the last calculation the stored sums are returned.
+	 */
+	const std::array<C, windows> & calculate()
+	{
+		if( dirty ) {
+			calculate_windows( delay_line.window(), window_indices() );
+			dirty = false;
+		}
+
+		return sums;
+	}
+
+	/**
+	 * adds the new input value and returns the divided results of all windows
+	 */
+	std::array<T, windows> operator()( T input )
+	{
+		add( input );
+		return get_result();
+	}
+
+	/**
+	 * Filters a whole block of samples, out[w][k] gets the
+	 * result of window w for in[k].
+	 */
+	void process( std::span<const T> in, const std::array<std::span<T>, windows> & out )
+	{
+		for( const std::span<T> & o : out ) {
+			if( o.size() < in.size() ) {
+				throw std::invalid_argument("Output block is smaller than the input block.");
+			}
+		}
+
+		std::array<T, taps + block_window_size> window;
+
+		process_blocks( delay_line, taps, window, in, [&]( const T * w, size_t pos, size_t count ) {
+			// the block window is in L1 now, all lengths are evaluated on it
+			process_block( w, out, pos, count, window_indices() );
+		});
+
+		if( !in.empty() ) {
+			dirty = false;
+		}
+	}
+
+	std::array<T, windows> get_result()
+	{
+		calculate();
+		return get_last_result();
+	}
+
+	std::array<T, windows> get_last_result() const
+	{
+		std::array<T, windows> results;
+
+		for( unsigned w = 0; w < windows; ++w ) {
+			results[w] = normalizers[w]( sums[w] );
+		}
+
+		return results;
+	}
+
+	C get_default_denominator( unsigned window ) const {
+		return normalizers.at( window ).get();
+	}
+
+	void set_default_denominator( unsigned window, C dd ) {
+		normalizers.at( window ).set( dd );
+	}
+
+protected:
+	/**
+	 * x points to the last taps samples, oldest first.
+	 * Without fused multiply adds, like the block kernels.
+	 */
+	template<std::size_t... W>
+	EXMATH_NO_FP_CONTRACT
+	void calculate_windows( const T * x, std::index_sequence<W...> )
+	{
+		constexpr unsigned max_half = taps / 2;
+
+		std::array<C, windows> s{};
+
+		// from outside to inside like Filter, so every window
+		// accumulates in the same order as Filter<T,C,N>
+		for( unsigned i = 0; i < max_half; ++i ) {
+			const C newer = C(x[taps-1-i]);
+
+			( add_pair<W>( s[W], x, newer, i ), ... );
+		}
+
+		sums = s;
+	}
+
+	template<std::size_t W>
+	[[gnu::always_inline]] static void add_pair( C & sum, const T * x, C newer, unsigned i )
+	{
+		constexpr unsigned N = window_sizes[W];
+
+		if( i < N/2 ) {
+			sum += std::get<W>( folded_coefficients )[i] * ( newer - C(x[taps-N+i]) );
+		}
+	}
+
+	/**
+	 * x points to the window of the first output, the longest one
+	 */
+	template<std::size_t... W>
+	void process_block( const T * x, const std::array<std::span<T>, windows> & out,
+						size_t pos, size_t count, std::index_sequence<W...> )
+	{
+		( process_block_window<W>( x, out[W], pos, count ), ... );
+	}
+
+	template<std::size_t W>
+	void process_block_window( const T * x, std::span<T> out, size_t pos, size_t count )
+	{
+		constexpr unsigned N = window_sizes[W];
+		const T * w = x + taps - N;
+
+		std::array<C, block_window_size> block_sums;
+
+		if constexpr( has_simd_kernels ) {
+			simd::folded_block( w, std::get<W>( folded_coefficients ).data(), N, block_sums.data(), count );
+		} else {
+			simd::scalar::folded_block( w, 1, std::get<W>( folded_coefficients ).data(), N, block_sums.data(), count );
+		}
+
+		for( size_t k = 0; k < count; ++k ) {
+			out[pos + k] = normalizers[W]( block_sums[k] );
+		}
+
+		sums[W] = block_sums[count-1];
+	}
+};
+
+} // namespace exmath::Filter::SNRDFir
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <concepts>
+#include "SNRDFir.hpp"
+
+/*
+ * Floating point SNRD differentiator without any division per output.
+ *
+ * The normalization by the default denominator, an adjusted denominator
+ * (set_default_denominator) and an optional physical unit scale,
+ * eg sample rate * volts per LSB, are applied as scale / denominator =
+ * factor * 2^exp. The power of two is folded into the coefficients,
+ * which doesn't round anything, so the sums are the ones of Filter times
+ * 2^exp. The factor is one multiply per output. The results are within
+ * 1 ulp of the sum of Filter * scale / denominator, and identical to
+ * the ones of Filter for a power of two scale and denominator.
+ *
+ * Filter::SNRDFir::NormalizedFilter<float,float,27*2+1> filter( sample_rate * 3.3 / 4096 );
+ *
+ * volts_per_second = filter( adc_value );
+ */
+
+namespace exmath::Filter::SNRDFir {
+
+template <std::floating_point T, std::floating_point C, unsigned N>
+class NormalizedFilter : public Filter<T,C,N,internal::InstanceCoefficients<C,N>>
+{
+	// the only filter with its own copy of the taps, since it modifies them
+	typedef Filter<T,C,N,internal::InstanceCoefficients<C,N>> Base;
+
+	C denominator = Base::calc_default_denominator();
+	C output_scale = 1;
+
+public:
+	explicit NormalizedFilter( C output_scale_ = 1 )
+	: output_scale( output_scale_ )
+	{
+		fold();
+	}
+
+	C get_default_denominator() const {
+		return denominator;
+	}
+
+	void set_default_denominator( C dd ) {
+		denominator = dd;
+		fold();
+	}
+
+	C get_output_scale() const {
+		return output_scale;
+	}
+
+	void set_output_scale( C scale ) {
+		output_scale = scale;
+		fold();
+	}
+
+private:
+	void fold()
+	{
+		constexpr std::array<C, N/2> coefficients = Base::calc_folded_coefficients();
+
+		// long double, so the factor is rounded only once
+		int exp = 0;
+		const C factor = static_cast<C>( std::frexp( static_cast<long double>( output_scale ) / denominator, &exp ) );
+
+		for( unsigned i = 0; i < N/2; ++i ) {
+			this->folded_coefficients.values[i] = std::ldexp( coefficients[i], exp );
+		}
+
+		this->normalizer.set_factor( factor );
+		this->dirty = true;
+	}
+};
+
+} // namespace exmath::Filter::SNRDFir
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "SNRDFir.hpp"
+
+/*
+ * Multithreaded block processing of long recordings.
+ *
+ * The filters are FIR filters, so an output only depends on the last N
+ * inputs. A block is split into chunks, every chunk gets its own copy of
+ * the filter, primed with the N-1 samples in front of the chunk, and the
+ * chunks are filtered on a pool of worker threads.
+ *
+ * The results are exactly the same as the ones of FILTER::process(),
+ * including the filter state afterwards.
+ *
+ * Filter::SNRDFir::ParallelFilter<Filter::SNRDFir::Filter<double,double,397*2+1>> filter( 8 );
+ *
+ * filter.process( recording, result );
+ */
+
+namespace exmath::Filter::SNRDFir {
+
+namespace internal {
+
+	/**
+	 * the number of taps, fixed at compile time like in Filter
+	 * or at runtime like in DynamicFilter
+	 */
+	template<class FILTER>
+	std::size_t taps_of( const FILTER & filter )
+	{
+		if constexpr( requires { FILTER::taps; } ) {
+			return FILTER::taps;
+		} else {
+			return filter.get_taps();
+		}
+	}
+
+} // namespace internal
+
+template <class FILTER>
+requires requires( const FILTER & f ) { internal::taps_of( f ); }
+class ParallelFilter
+{
+	typedef std::remove_cvref_t<decltype( std::declval<FILTER&>().get_result() )> T;
+
+	FILTER filter;
+	std::size_t chunk_size;
+	std::vector<std::thread> workers;
+
+	std::mutex mutex;
+	std::condition_variable work_available;
+	std::condition_variable work_done;
+
+	// the current job, guarded by mutex
+	std::span<const T> job_in;
+	std::span<T> job_out;
+	std::size_t next_chunk = 0;
+	std::size_t chunk_count = 0;
+	std::size_t chunks_done = 0;
+	std::optional<FILTER> last_chunk_filter;
+	std::exception_ptr error;
+	bool stop = false;
+
+public:
+	/**
+	 * Chunks smaller than 64 times the filter length waste
+	 * too much time priming the filters.
+	 */
+	static constexpr std::size_t default_chunk_size( std::size_t taps ) {
+		return std::max<std::size_t>( 64 * 1024, 64 * taps );
+	}
+
+	/**
+	 * threads 0 uses all cores, the calling thread is one of them,
+	 * chunk_size 0 uses default_chunk_size()
+	 */
+	explicit ParallelFilter( unsigned threads = 0,
+							 std::size_t chunk_size_ = 0,
+							 const FILTER & filter_ = FILTER() )
+	: filter( filter_ ),
+	  chunk_size( chunk_size_ ? chunk_size_ : default_chunk_size( internal::taps_of( filter_ ) ) )
+	{
+		if( chunk_size < internal::taps_of( filter ) ) {
+			throw std::invalid_argument("Chunk size has to be at least the number of taps.");
+		}
+
+		if( threads == 0 ) {
+			threads = std::max( 1u, std::thread::hardware_concurrency() );
+		}
+
+		for( unsigned i = 1; i < threads; ++i ) {
+			workers.emplace_back( [this]() { worker(); } );
+		}
+	}
+
+	~ParallelFilter()
+	{
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			stop = true;
+		}
+
+		work_available.notify_all();
+
+		for( std::thread & t : workers ) {
+			t.join();
+		}
+	}
+
+	ParallelFilter( const ParallelFilter & other ) = delete;
+	ParallelFilter & operator=( const ParallelFilter & other ) = delete;
+
+	unsigned get_threads() const {
+		return workers.size() + 1;
+	}
+
+	std::size_t get_chunk_size() const {
+		return chunk_size;
+	}
+
+	FILTER & get_filter() {
+		return filter;
+	}
+
+	const FILTER & get_filter() const {
+		return filter;
+	}
+
+	/**
+	 * Filters a whole block of samples.
+	 * out[k] gets exactly the value filter.process() would have written.
+	 */
+	void process( std::span<const T> in, std::span<T> out )
+	{
+		if( out.size() < in.size() ) {
+			throw std::invalid_argument("Output block is smaller than the input block.");
+		}
+
+		const std::size_t count = ( in.size() + chunk_size - 1 ) / chunk_size;
+
+		if( workers.empty() || count < 2 ) {
+			filter.process( in, out );
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			job_in = in;
+			job_out = out;
+			next_chunk = 0;
+			chunk_count = count;
+			chunks_done = 0;
+			last_chunk_filter.reset();
+			error = nullptr;
+		}
+
+		work_available.notify_all();
+
+		// the calling thread helps out
+		run_chunks();
+
+		std::unique_lock<std::mutex> lock( mutex );
+		work_done.wait( lock, [this]() { return chunks_done == chunk_count; } );
+
+		chunk_count = 0;
+
+		if( error ) {
+			std::rethrow_exception( error );
+		}
+
+		// the state after the last chunk is the state after the whole block
+		filter = *last_chunk_filter;
+	}
+
+private:
+	void worker()
+	{
+		std::unique_lock<std::mutex> lock( mutex );
+
+		while( true ) {
+			work_available.wait( lock, [this]() { return stop || next_chunk < chunk_count; } );
+
+			if( stop ) {
+				return;
+			}
+
+			lock.unlock();
+			run_chunks();
+			lock.lock();
+		}
+	}
+
+	/**
+	 * processes chunks of the current job until none are left
+	 */
+	void run_chunks()
+	{
+		std::unique_lock<std::mutex> lock( mutex );
+
+		while( next_chunk < chunk_count ) {
+			const std::size_t chunk = next_chunk++;
+			const bool last = chunk + 1 == chunk_count;
+
+			lock.unlock();
+
+			std::optional<FILTER> result;
+			std::exception_ptr chunk_error;
+
+			try {
+				result = run_chunk( chunk );
+			} catch( ... ) {
+				chunk_error = std::current_exception();
+			}
+
+			lock.lock();
+
+			if( chunk_error && !error ) {
+				error = chunk_error;
+			}
+
+			if( last && result ) {
+				last_chunk_filter = std::move( result );
+			}
+
+			if( ++chunks_done == chunk_count ) {
+				work_done.notify_all();
+			}
+		}
+	}
+
+	/**
+	 * job_in and job_out are not modified while chunks are running
+	 */
+	FILTER run_chunk( std::size_t chunk )
+	{
+		const std::size_t begin = chunk * chunk_size;
+		const std::size_t count = std::min( chunk_size, job_in.size() - begin );
+
+		// the first chunk continues the filter state, every other
+		// one replaces the whole history by the samples in front of it
+		FILTER f = filter;
+
+		if( chunk > 0 ) {
+			const std::size_t history = internal::taps_of( f ) - 1;
+			std::vector<T> scratch( history );
+
+			f.process( job_in.subspan( begin - history, history ), std::span<T>( scratch ) );
+		}
+
+		f.process( job_in.subspan( begin, count ), job_out.subspan( begin, count ) );
+
+		return f;
+	}
+};
+
+} // namespace exmath::Filter::SNRDFir
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "SpscRing.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <immintrin.h>
+#endif
+
+/*
+ * Filtering on a dedicated thread, decoupled from the acquisition.
+ *
+ * The acquisition thread pushes raw samples into a wait free SPSC ring
+ * and never waits for the filter. A filter thread pops them in batches,
+ * runs the block filter and publishes the results to a second SPSC ring,
+ * which the application reads from.
+ *
+ * A full input ring drops the new samples, a full output ring drops the
+ * new results. Both are counted as overruns, nothing ever blocks the
+ * producer.
+ *
+ * Filter::SNRDFir::Pipeline<Filter::SNRDFir::Filter<int64_t,int64_t,27*2+1>> pipeline;
+ *
+ * acquisition thread:  pipeline.push( adc_value );
+ * application thread:  std::size_t n = pipeline.pop( results );
+ */
+
+namespace exmath::Filter::SNRDFir {
+
+struct PipelineConfig
+{
+	enum class Wait
+	{
+		busy_poll,      // lowest latency, the filter thread burns a core
+		futex           // the filter thread sleeps while the input ring is empty
+	};
+
+	std::size_t input_capacity = 1 << 16;
+	std::size_t output_capacity = 1 << 16;
+
+	/**
+	 * Maximum number of samples filtered at once. With futex wait the
+	 * sleeping filter thread is only woken once that many samples wait,
+	 * so the producer does not pay for a system call per sample.
+	 */
+	std::size_t batch_size = 256;
+
+	Wait wait = Wait::futex;
+};
+
+template <class FILTER>
+class Pipeline
+{
+	typedef std::remove_cvref_t<decltype( std::declval<FILTER&>().get_result() )> T;
+
+public:
+	struct Counters
+	{
+		uint64_t samples_in;         // samples accepted by push()
+		uint64_t samples_filtered;   // samples the filter thread has processed
+		uint64_t input_overruns;     // samples dropped, the input ring was full
+		uint64_t output_overruns;    // results dropped, the output ring was full
+		std::size_t input_depth;     // samples waiting in the input ring
+		std::size_t output_depth;    // results waiting in the output ring
+		std::size_t max_input_depth; // highest input depth the filter thread has seen
+	};
+
+private:
+	const PipelineConfig config;
+
+	SpscRing<T> input;
+	SpscRing<T> output;
+
+	// written by the producer only
+	alignas(SpscRing<T>::cache_line) std::atomic<uint64_t> samples_in{ 0 };
+	std::atomic<uint64_t> input_overruns{ 0 };
+
+	// written by the filter thread only
+	alignas(SpscRing<T>::cache_line) std::atomic<uint64_t> samples_filtered{ 0 };
+	std::atomic<uint64_t> output_overruns{ 0 };
+	std::atomic<std::size_t> max_input_depth{ 0 };
+
+	// futex wait: the filter thread sleeps on wake_count while sleeping is set
+	alignas(SpscRing<T>::cache_line) std::atomic<uint32_t> wake_count{ 0 };
+	std::atomic<bool> sleeping{ false };
+	std::atomic<bool> stop{ false };
+
+	FILTER filter;
+	std::thread worker;
+
+public:
+	explicit Pipeline( const PipelineConfig & config_ = PipelineConfig(),
+					   const FILTER & filter_ = FILTER() )
+	: config( check_config( config_ ) ),
+	  input( config.input_capacity ),
+	  output( config.output_capacity ),
+	  filter( filter_ ),
+	  worker( [this]() { run(); } )
+	{
+	}
+
+	/**
+	 * filters everything pushed so far, then stops the filter thread
+	 */
+	~Pipeline()
+	{
+		stop.store( true, std::memory_order_seq_cst );
+		wake();
+		worker.join();
+	}
+
+	Pipeline( const Pipeline & other ) = delete;
+	Pipeline & operator=( const Pipeline & other ) = delete;
+
+	/**
+	 * Producer thread only. Never blocks, samples that don't
+	 * fit into the input ring are dropped and counted.
+	 * Returns the number of samples accepted.
+	 */
+	std::size_t push( std::span<const T> samples )
+	{
+		const std::size_t count = input.push( samples );
+
+		samples_in.store( samples_in.load( std::memory_order_relaxed ) + count, std::memory_order_relaxed );
+
+		if( count < samples.size() ) {
+			input_overruns.store( input_overruns.load( std::memory_order_relaxed ) + samples.size() - count,
+								  std::memory_order_relaxed );
+		}
+
+		if( config.wait == PipelineConfig::Wait::futex ) {
+			// pairs with the fence in wait_for_input(), either the filter
+			// thread sees the new samples or we see it sleeping
+			std::atomic_thread_fence( std::memory_order_seq_cst );
+
+			// only the push clearing the flag wakes it, not every push
+			// until the filter thread actually runs
+			if( sleeping.load( std::memory_order_relaxed ) &&
+				input.size() >= config.batch_size &&
+				sleeping.exchange( false, std::memory_order_relaxed ) ) {
+				wake();
+			}
+		}
+
+		return count;
+	}
+
+	bool push( const T & sample ) {
+		return push( std::span<const T>( &sample, 1 ) ) == 1;
+	}
+
+	/**
+	 * Consumer thread only. Fills results from the beginning,
+	 * returns the number of results. Never blocks.
+	 */
+	std::size_t pop( std::span<T> results ) {
+		return output.pop( results );
+	}
+
+	/**
+	 * Producer thread only. Waits until every sample pushed so far is filtered,
+	 * including an incomplete batch.
+	 */
+	void flush()
+	{
+		const uint64_t target = samples_in.load( std::memory_order_relaxed );
+
+		wake();
+
+		while( samples_filtered.load( std::memory_order_acquire ) < target ) {
+			std::this_thread::yield();
+		}
+	}
+
+	Counters get_counters() const
+	{
+		return Counters{
+			samples_in.load( std::memory_order_relaxed ),
+			samples_filtered.load( std::memory_order_relaxed ),
+			input_overruns.load( std::memory_order_relaxed ),
+			output_overruns.load( std::memory_order_relaxed ),
+			input.size(),
+			output.size(),
+			max_input_depth.load( std::memory_order_relaxed )
+		};
+	}
+
+	const PipelineConfig & get_config() const {
+		return config;
+	}
+
+private:
+	static const PipelineConfig & check_config( const PipelineConfig & config )
+	{
+		if( config.batch_size == 0 ) {
+			throw std::invalid_argument("Batch size has to be at least 1.");
+		}
+
+		return config;
+	}
+
+	void wake()
+	{
+		wake_count.fetch_add( 1, std::memory_order_seq_cst );
+		wake_count.notify_one();
+	}
+
+	static void cpu_relax()
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		_mm_pause();
+#endif
+	}
+
+	void wait_for_input()
+	{
+		if( config.wait == PipelineConfig::Wait::busy_poll ) {
+			cpu_relax();
+			return;
+		}
+
+		const uint32_t count = wake_count.load( std::memory_order_seq_cst );
+
+		sleeping.store( true, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+
+		if( input.empty() && !stop.load( std::memory_order_seq_cst ) ) {
+			// returns at once if wake() was called since count was read
+			wake_count.wait( count, std::memory_order_seq_cst );
+		}
+
+		sleeping.store( false, std::memory_order_relaxed );
+	}
+
+	/**
+	 * the filter thread
+	 */
+	void run()
+	{
+		std::vector<T> in( config.batch_size );
+		std::vector<T> out( config.batch_size );
+
+		while( true ) {
+			const std::size_t depth = input.size();
+
+			if( depth > max_input_depth.load( std::memory_order_relaxed ) ) {
+				max_input_depth.store( depth, std::memory_order_relaxed );
+			}
+
+			const std::size_t count = input.pop( in );
+
+			if( count == 0 ) {
+				if( stop.load( std::memory_order_acquire ) && input.empty() ) {
+					return;
+				}
+
+				wait_for_input();
+				continue;
+			}
+
+			filter.process( std::span<const T>( in.data(), count ), std::span<T>( out.data(), count ) );
+
+			const std::size_t published = output.push( std::span<const T>( out.data(), count ) );
+
+			if( published < count ) {
+				output_overruns.store( output_overruns.load( std::memory_order_relaxed ) + count - published,
+									   std::memory_order_relaxed );
+			}
+
+			samples_filtered.store( samples_filtered.load( std::memory_order_relaxed ) + count,
+									std::memory_order_release );
+		}
+	}
+};
+
+} // namespace exmath::Filter::SNRDFir
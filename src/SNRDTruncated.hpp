@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "SNRDCompensated.hpp"
+#include "SNRDDynamic.hpp"
+
+/*
+ * Long floating point SNRD differentiators without their outer taps.
+ *
+ * Relative to the default denominator the outer taps of a long filter are
+ * tiny, the catalan line ends with ..., 52, 1 while the central taps are
+ * about 2^(N-2) / sqrt(N). Dropping the outermost k taps on both sides
+ * leaves a filter of M = N - 2k taps, which needs a history of M samples
+ * only and M/2 multiplications per output.
+ *
+ * With |x| <= max_input every difference x[N-1-i] - x[i] is at most
+ * 2 * max_input, so the result changes by at most
+ *
+ *   2 * max_input * sum( tap[i] / 2^(N-2) ) over the dropped taps.
+ *
+ * truncated_taps() returns the smallest M keeping this below a tolerance.
+ * The bound is calculated from the exact taps, it does not include the
+ * rounding errors of the remaining calculation.
+ *
+ * The estimate is (M-1)/2 samples in the past instead of (N-1)/2, the
+ * result for a sample is the one Filter<T,C,N> returns (N-M)/2 samples later.
+ *
+ * TruncatedFilter is CompensatedFilter with the kept taps only, the taps
+ * are normalized, the sum is the result.
+ *
+ * constexpr unsigned M = Filter::SNRDFir::truncated_taps<double,397*2+1>( 4096, 1e-9 );
+ * Filter::SNRDFir::TruncatedFilter<double,double,397*2+1,M> filter;
+ *
+ * or with N and the tolerance from a config file:
+ *
+ * Filter::SNRDFir::DynamicTruncatedFilter<double,double> filter( config.taps, 4096, config.tolerance );
+ */
+
+namespace exmath::Filter::SNRDFir {
+
+namespace internal {
+
+	/**
+	 * Number of folded taps to drop from the outside, outermost first.
+	 * At least one folded tap is kept.
+	 */
+	template<typename C>
+	constexpr unsigned calc_dropped_taps( std::span<const long double> folded, C max_input, C tolerance )
+	{
+		if( max_input < 0 || tolerance < 0 ) {
+			throw std::invalid_argument("Maximum input value and tolerance have to be positive.");
+		}
+
+		long double dropped = 0;
+		unsigned count = 0;
+
+		for( ; count + 1 < folded.size(); ++count ) {
+			const long double next = dropped + folded[count];
+
+			if( 2 * static_cast<long double>( max_input ) * next > static_cast<long double>( tolerance ) ) {
+				break;
+			}
+
+			dropped = next;
+		}
+
+		return count;
+	}
+
+	struct Truncation
+	{
+		unsigned    full_taps;
+		unsigned    taps;         // kept
+		long double error;        // for the max_input the taps were chosen for
+	};
+
+	/**
+	 * truncated_taps() and the truncation error for a full_taps only known at runtime
+	 */
+	template<typename C>
+	Truncation calc_truncation( unsigned full_taps, C max_input, C tolerance )
+	{
+		std::vector<long double> exact = calc_last_line_of_catalan_triangle<long double>( full_taps / 2, -static_cast<int>( full_taps - 2 ) );
+		std::reverse( exact.begin(), exact.end() );
+
+		const unsigned dropped = calc_dropped_taps<C>( exact, max_input, tolerance );
+
+		return { full_taps, full_taps - 2 * dropped, 2 * static_cast<long double>( max_input ) * calc_dropped_sum( exact, dropped ) };
+	}
+
+	/**
+	 * the central taps/2 of calc_normalized_folded_coefficients<C,full_taps>(), outermost first
+	 */
+	template<typename C>
+	std::vector<C> calc_truncated_coefficients( unsigned full_taps, unsigned taps )
+	{
+		// innermost first, so the kept taps are the first ones
+		std::vector<C> folded = calc_last_line_of_catalan_triangle<C>( full_taps / 2, -static_cast<int>( full_taps - 2 ) );
+		folded.resize( taps / 2 );
+		std::reverse( folded.begin(), folded.end() );
+
+		for( C & c : folded ) {
+			if( c < std::numeric_limits<C>::min() ) {
+				c = 0;
+			}
+		}
+
+		return folded;
+	}
+
+	/**
+	 * shared like the taps of DynamicFilter, in a registry of their own
+	 */
+	template<typename C>
+	const std::vector<C> & get_truncated_coefficients( unsigned full_taps, unsigned taps )
+	{
+		typedef CoefficientRegistry<C, std::pair<unsigned,unsigned>> Registry;
+
+		return Registry::instance().get( { full_taps, taps }, [full_taps, taps]() {
+			return calc_truncated_coefficients<C>( full_taps, taps );
+		});
+	}
+
+} // namespace internal
+
+/**
+ * The smallest number of taps M of Filter<T,C,N> to keep, so that the
+ * dropped taps change no result by more than tolerance, for inputs up to
+ * |max_input|. Evaluate it as constexpr to get M at compile time.
+ */
+template<std::floating_point C, unsigned N>
+requires internal::odds_only<unsigned, N> && ( N >= 3 )
+constexpr unsigned truncated_taps( C max_input, C tolerance )
+{
+	constexpr std::array<long double, N/2> folded = internal::calc_exact_normalized_folded_coefficients<N>();
+
+	return N - 2 * internal::calc_dropped_taps<C>( folded, max_input, tolerance );
+}
+
+/**
+ * CompensatedFilter<T,C,N,mode,M>, the central M of N taps,
+ * with truncation_error() for the dropped ones
+ */
+template <std::floating_point T, std::floating_point C, unsigned N, unsigned M,
+		  Accumulation mode = Accumulation::ordered>
+using TruncatedFilter = CompensatedFilter<T,C,N,mode,M>;
+
+/**
+ * TruncatedFilter with N and the tolerance chosen at runtime.
+ *
+ * A DynamicFilter with the kept normalized taps and a denominator of 1,
+ * so the results are exactly the ones of TruncatedFilter<T,C,N,M> with
+ * an output scale of 1. set_default_denominator( 1 / scale ) scales them,
+ * for a power of two exactly like the output scale of TruncatedFilter.
+ */
+template <std::floating_point T, std::floating_point C>
+class DynamicTruncatedFilter : public DynamicFilter<T,C>
+{
+	typedef DynamicFilter<T,C> Base;
+
+	unsigned full_taps;
+	C        error_bound;
+
+public:
+	/**
+	 * Drops the outer taps of an N = full_taps filter, as long as no result
+	 * changes by more than tolerance for inputs up to |max_input|.
+	 */
+	DynamicTruncatedFilter( unsigned full_taps_, C max_input, C tolerance )
+	: DynamicTruncatedFilter( internal::calc_truncation<C>( Base::check_taps( full_taps_ ), max_input, tolerance ) )
+	{
+	}
+
+	/**
+	 * number of taps of the filter the taps are taken from, get_taps() returns the kept ones
+	 */
+	unsigned get_full_taps() const {
+		return full_taps;
+	}
+
+	/**
+	 * the most the dropped taps change a result by, for the max_input
+	 * of the constructor and without the denominator
+	 */
+	C get_truncation_error() const {
+		return error_bound;
+	}
+
+private:
+	explicit DynamicTruncatedFilter( const internal::Truncation & truncation )
+	: Base( truncation.taps, internal::get_truncated_coefficients<C>( truncation.full_taps, truncation.taps ), 1 ),
+	  full_taps( truncation.full_taps ),
+	  error_bound( static_cast<C>( truncation.error ) )
+	{
+	}
+};
+
+} // namespace exmath::Filter::SNRDFir
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include "SNRDFir.hpp"
+
+/*
+ * SNRD differentiator evaluated directly on caller owned buffers,
+ * eg the halves of a DMA double buffer or a memory mapped capture.
+ *
+ * Filter copies every sample into its delay line. FilterView reads the
+ * samples where they are. Only the last N-1 samples of a block are kept,
+ * so the next block can continue where this one ended. Only the first
+ * outputs of a block need them, everything after that is read from
+ * the block itself.
+ *
+ * The results are exactly the ones of Filter<T,C,N>.
+ *
+ * Filter::SNRDFir::FilterView<int32_t,int64_t,27*2+1> view;
+ *
+ * dma half complete:  view.process( dma_buffer.first( half ), results );
+ * dma complete:       view.process( dma_buffer.last( half ), results );
+ *
+ * or without any state, if the history is in front of the samples anyway:
+ *
+ * view.evaluate( capture.subspan( first - (N-1), count + N-1 ), results );
+ */
+
+namespace exmath::Filter::SNRDFir {
+
+template <typename T, typename C, unsigned N>
+requires internal::odds_only<unsigned, N>
+class FilterView
+{
+public:
+	/**
+	 * number of taps, the output depends on the last taps input samples
+	 */
+	static constexpr unsigned taps = N;
+
+	/**
+	 * samples carried over from one block to the next
+	 */
+	static constexpr unsigned history_size = N - 1;
+
+	/**
+	 * number of sums calculated at once
+	 */
+	static constexpr unsigned block_window_size = 256;
+
+	static constexpr bool has_simd_kernels = simd::supported_pair<T,C>;
+
+protected:
+	/**
+	 * Outputs taken from the seam between the history and a new block.
+	 * A whole number of vectors (16 lanes at most), so neither kernel
+	 * call ends in a scalar tail for the usual block sizes.
+	 */
+	static constexpr std::size_t seam_outputs = ( history_size + 15 ) / 16 * 16;
+
+	/**
+	 * the table of Filter<T,C,N>, not a copy
+	 */
+	typedef internal::SharedCoefficients<C,N> Coefficients;
+
+	/**
+	 * the last N-1 samples of the previous blocks, oldest first
+	 */
+	std::array<T, history_size> history{};
+
+	C       sum = 0;
+	internal::Normalizer<C> normalizer{ Filter<T,C,N>::calc_default_denominator() };
+
+public:
+	/**
+	 * Filters the next block, continuing the previous one.
+	 * out[k] gets exactly the value Filter::operator()( in[k] ) would have returned.
+	 */
+	void process( std::span<const T> in, std::span<T> out )
+	{
+		if( out.size() < in.size() ) {
+			throw std::invalid_argument("Output block is smaller than the input block.");
+		}
+
+		if( in.empty() ) {
+			return;
+		}
+
+		// the first outputs reach back into the previous block
+		const std::size_t head = std::min<std::size_t>( in.size(), seam_outputs );
+
+		std::array<T, history_size + seam_outputs> seam;
+		std::copy( history.begin(), history.end(), seam.begin() );
+		std::copy_n( in.begin(), head, seam.begin() + history_size );
+
+		sum = evaluate_windows( seam.data(), head, out.data() );
+
+		// all following windows are inside the block
+		if( in.size() > head ) {
+			sum = evaluate_windows( in.data() + head - history_size, in.size() - head, out.data() + head );
+		}
+
+		// the newest N-1 samples
+		if( in.size() >= history_size ) {
+			std::copy_n( in.end() - history_size, history_size, history.begin() );
+		} else {
+			std::copy_n( seam.begin() + head, history_size, history.begin() );
+		}
+	}
+
+	/**
+	 * Result for the newest sample of window, from its last N samples.
+	 * Uses no state.
+	 */
+	T evaluate( std::span<const T> window ) const
+	{
+		check_window( window );
+
+		C output;
+		evaluate_sums( window.data() + window.size() - N, 1, &output );
+
+		return normalizer( output );
+	}
+
+	/**
+	 * One result for every sample of window that has N-1 samples in front
+	 * of it, out[k] for window[k+N-1]. Uses no state.
+	 * Returns the number of results.
+	 */
+	std::size_t evaluate( std::span<const T> window, std::span<T> out ) const
+	{
+		check_window( window );
+
+		const std::size_t count = window.size() - history_size;
+
+		if( out.size() < count ) {
+			throw std::invalid_argument("Output block is too small for this window.");
+		}
+
+		evaluate_windows( window.data(), count, out.data() );
+
+		return count;
+	}
+
+	/**
+	 * the samples the next block continues, oldest first
+	 */
+	std::span<const T, history_size> get_history() const {
+		return history;
+	}
+
+	/**
+	 * forgets the history, as if only zeros had been filtered
+	 */
+	void reset()
+	{
+		history.fill( T(0) );
+		sum = 0;
+	}
+
+	/**
+	 * choose last sum and divide it
+	 */
+	T get_last_result() const {
+		return normalizer( sum );
+	}
+
+	C get_default_denominator() const {
+		return normalizer.get();
+	}
+
+	void set_default_denominator( C dd ) {
+		normalizer.set( dd );
+	}
+
+	const std::array<C, N/2> & get_folded_coefficients() const {
+		return Coefficients::values;
+	}
+
+protected:
+	static void check_window( std::span<const T> window )
+	{
+		if( window.size() < N ) {
+			throw std::invalid_argument("Window is smaller than the number of taps.");
+		}
+	}
+
+	/**
+	 * sums[k] for the window w[k] ... w[k+N-1], in the order of Filter
+	 */
+	static void evaluate_sums( const T * w, std::size_t count, C * sums )
+	{
+		if constexpr( has_simd_kernels ) {
+			simd::folded_block( w, Coefficients::values.data(), N, sums, count );
+		} else {
+			simd::scalar::folded_block( w, 1, Coefficients::values.data(), N, sums, count );
+		}
+	}
+
+	/**
+	 * out[k] for the window w[k] ... w[k+N-1], returns the last sum
+	 */
+	C evaluate_windows( const T * w, std::size_t count, T * out ) const
+	{
+		std::array<C, block_window_size> sums;
+		C last = sum;
+
+		for( std::size_t pos = 0; pos < count; ) {
+			const std::size_t chunk = std::min<std::size_t>( block_window_size, count - pos );
+
+			evaluate_sums( w + pos, chunk, sums.data() );
+
+			for( std::size_t k = 0; k < chunk; ++k ) {
+				out[pos + k] = normalizer( sums[k] );
+			}
+
+			last = sums[chunk-1];
+			pos += chunk;
+		}
+
+		return last;
+	}
+};
+
+} // namespace exmath::Filter::SNRDFir
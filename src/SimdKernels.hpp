@@ -0,0 +1,948 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+/*
+ * Runtime dispatched SIMD kernels for the FIR filters.
+ *
+ * Each kernel is compiled for SSE4.2, AVX2 and AVX-512 via function target
+ * attributes. The best variant the running CPU supports is selected once
+ * by CPUID, so one binary runs on every x86-64 machine at full speed.
+ * On other architectures only the scalar reference kernels exist.
+ *
+ * Kernels are available for float, double, int32_t and int64_t, where
+ * input, coefficients and accumulator have the same type. Narrower input
+ * types are supported as well (int16_t or int32_t input with int32_t or
+ * int64_t accumulation, float input with double accumulation), they are
+ * widened after loading.
+ *
+ * folded_block() evaluates the folded SNRD sum for several consecutive
+ * outputs at once, one output per vector lane. Each lane accumulates the
+ * taps in the same order as the scalar code, so the results are bit
+ * identical for all types. With a stride it evaluates several channels
+ * stored side by side (one row of samples per point in time) instead.
+ *
+ * folded_block_fixed<N>() is folded_block() for one tap count known at
+ * compile time, the compiler unrolls the tap loop. It is meant for filters
+ * choosing N at runtime, that dispatch the common lengths to it.
+ *
+ * fir_block() is folded_block() for tap sets without any symmetry,
+ * every tap is multiplied with its own sample.
+ *
+ * fused_block() evaluates two symmetric and one antisymmetric tap set
+ * in one pass, every sample pair is loaded once for all three sums.
+ * Like folded_block() it is bit identical to the scalar code.
+ *
+ * folded_block_compensated() is folded_block() with a smaller rounding
+ * error for float and double. The taps are summed in blocks of
+ * compensation_block, the block sums are added with compensated summation
+ * (TwoSum). The error is about compensation_block + 3 units in the last
+ * place of sum( |cf[i] * d[i]| ) instead of n/2 + 1, for one extra add per
+ * tap block. Bit identical to the scalar code as well. Don't build it
+ * with -ffast-math, that removes the compensation.
+ *
+ * folded_sum() and dot() evaluate one output over all lanes, which
+ * changes the summation order. folded_sum() is therefore only used for
+ * integer types, dot() results for float and double may differ from the
+ * scalar reference by rounding.
+ */
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#  define EXMATH_SIMD_X86 1
+#endif
+
+/*
+ * For the scalar reference code of float and double. With FMA available
+ * (eg -march=native) GCC would contract a multiply and an add into one
+ * fused multiply add, which rounds differently than the kernels below.
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+#  define EXMATH_NO_FP_CONTRACT __attribute__((optimize("fp-contract=off")))
+#else
+#  define EXMATH_NO_FP_CONTRACT
+#endif
+
+namespace exmath::Filter::simd {
+
+enum class ISA
+{
+	scalar = 0,
+	sse42,
+	avx2,
+	avx512
+};
+
+static constexpr unsigned ISA_COUNT = 4;
+
+template<typename T>
+concept supported =
+	std::is_same_v<T,float>
+	|| std::is_same_v<T,double>
+	|| std::is_same_v<T,int32_t>
+	|| std::is_same_v<T,int64_t>;
+
+/**
+ * input type T, coefficient and accumulator type C
+ */
+template<typename T, typename C>
+concept supported_pair =
+	( supported<C> && std::is_same_v<T,C> )
+	|| ( std::is_same_v<T,int16_t> && std::is_same_v<C,int32_t> )
+	|| ( std::is_same_v<T,int16_t> && std::is_same_v<C,int64_t> )
+	|| ( std::is_same_v<T,int32_t> && std::is_same_v<C,int64_t> )
+	|| ( std::is_same_v<T,float> && std::is_same_v<C,double> );
+
+inline const char * isa_name( ISA isa )
+{
+	switch( isa ) {
+	case ISA::scalar: return "scalar";
+	case ISA::sse42:  return "sse4.2";
+	case ISA::avx2:   return "avx2";
+	case ISA::avx512: return "avx512";
+	}
+
+	return "unknown";
+}
+
+/**
+ * returns the best instruction set supported by this CPU
+ */
+inline ISA detect_isa()
+{
+#ifdef EXMATH_SIMD_X86
+	__builtin_cpu_init();
+
+	if( __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") ) {
+		return ISA::avx512;
+	}
+
+	if( __builtin_cpu_supports("avx2") ) {
+		return ISA::avx2;
+	}
+
+	if( __builtin_cpu_supports("sse4.2") ) {
+		return ISA::sse42;
+	}
+#endif
+
+	return ISA::scalar;
+}
+
+namespace internal {
+
+	inline ISA & isa_storage()
+	{
+		static ISA isa = detect_isa();
+		return isa;
+	}
+
+} // namespace internal
+
+/**
+ * the instruction set the kernels are currently dispatched to
+ */
+inline ISA active_isa()
+{
+	return internal::isa_storage();
+}
+
+/**
+ * Forces a specific instruction set, eg for benchmarks or tests.
+ * Throw's an exception if the CPU does not support it.
+ */
+inline void set_isa( ISA isa )
+{
+	if( isa > detect_isa() ) {
+		throw std::invalid_argument("Instruction set not supported by this CPU.");
+	}
+
+	internal::isa_storage() = isa;
+}
+
+/**
+ * taps summed plainly before a compensated add, see folded_block_compensated()
+ */
+constexpr unsigned compensation_block = 8;
+
+namespace scalar {
+
+/**
+ * sum + comp is value plus the sums before, the exact rounding error
+ * of every add is collected in comp. Knuth's TwoSum, the result of
+ * Neumaier's algorithm without its compare. For scalars and vectors.
+ */
+template<typename V>
+[[gnu::always_inline]] inline void compensated_add( V & sum, V & comp, const V & value )
+{
+	const V total = sum + value;
+	const V value_part = total - sum;
+
+	comp += ( sum - ( total - value_part ) ) + ( value - value_part );
+	sum = total;
+}
+
+/**
+ * sums[k] = sum( cf[i] * ( w[k+(n-1-i)*stride] - w[k+i*stride] ) ) for i < n/2
+ */
+template<typename T, typename C>
+EXMATH_NO_FP_CONTRACT
+void folded_block( const T * w, std::size_t stride, const C * cf, unsigned n, C * sums, std::size_t count )
+{
+	for( std::size_t k = 0; k < count; ++k ) {
+		C output = 0;
+
+		for( unsigned i = 0, j = n-1; i < n/2; ++i, --j ) {
+			output += cf[i] * ( C(w[k+j*stride]) - C(w[k+i*stride]) );
+		}
+
+		sums[k] = output;
+	}
+}
+
+template<unsigned N, typename T, typename C>
+EXMATH_NO_FP_CONTRACT
+void folded_block_fixed( const T * w, const C * cf, C * sums, std::size_t count )
+{
+	folded_block( w, 1, cf, N, sums, count );
+}
+
+/**
+ * folded_block() with compensated summation of the tap blocks
+ */
+template<typename T, typename C>
+EXMATH_NO_FP_CONTRACT
+void folded_block_compensated( const T * w, std::size_t stride, const C * cf, unsigned n, C * sums, std::size_t count )
+{
+	const unsigned half = n / 2;
+
+	for( std::size_t k = 0; k < count; ++k ) {
+		C sum = 0;
+		C comp = 0;
+
+		for( unsigned i = 0; i < half; i += compensation_block ) {
+			const unsigned end = std::min( i + compensation_block, half );
+			C part = 0;
+
+			for( unsigned t = i, j = n-1-i; t < end; ++t, --j ) {
+				part += cf[t] * ( C(w[k+j*stride]) - C(w[k+t*stride]) );
+			}
+
+			compensated_add( sum, comp, part );
+		}
+
+		sums[k] = sum + comp;
+	}
+}
+
+/**
+ * sums[k] = sum( cf[i] * w[k+i] ) for i < n
+ */
+template<typename T, typename C>
+EXMATH_NO_FP_CONTRACT
+void fir_block( const T * w, const C * cf, unsigned n, C * sums, std::size_t count )
+{
+	for( std::size_t k = 0; k < count; ++k ) {
+		C output = 0;
+
+		for( unsigned i = 0; i < n; ++i ) {
+			output += cf[i] * C(w[k+i]);
+		}
+
+		sums[k] = output;
+	}
+}
+
+template<typename T, typename C>
+EXMATH_NO_FP_CONTRACT
+C folded_sum( const T * w, const C * cf, unsigned n )
+{
+	C output;
+	folded_block( w, 1, cf, n, &output, 1 );
+	return output;
+}
+
+/**
+ * with h = n/2, i < h, j = n-1-i and p = w[k+j] + w[k+i], d = w[k+j] - w[k+i]:
+ *
+ * sums0[k] = sum( even0[i] * p ) + even0[h] * w[k+h]
+ * sums1[k] = sum( odd[i] * d )
+ * sums2[k] = sum( even1[i] * p ) + even1[h] * w[k+h]
+ */
+template<typename T, typename C>
+EXMATH_NO_FP_CONTRACT
+void fused_block( const T * w, const C * even0, const C * odd, const C * even1, unsigned n,
+				  C * sums0, C * sums1, C * sums2, std::size_t count )
+{
+	const unsigned half = n / 2;
+
+	for( std::size_t k = 0; k < count; ++k ) {
+		C s0 = 0;
+		C s1 = 0;
+		C s2 = 0;
+
+		for( unsigned i = 0, j = n-1; i < half; ++i, --j ) {
+			const C a = C(w[k+i]);
+			const C b = C(w[k+j]);
+			const C p = b + a;
+			const C d = b - a;
+
+			s0 += even0[i] * p;
+			s1 += odd[i] * d;
+			s2 += even1[i] * p;
+		}
+
+		const C center = C(w[k+half]);
+
+		sums0[k] = s0 + even0[half] * center;
+		sums1[k] = s1;
+		sums2[k] = s2 + even1[half] * center;
+	}
+}
+
+/**
+ * sum( c[i] * x[i] ) for i < n
+ */
+template<typename T, typename C>
+EXMATH_NO_FP_CONTRACT
+C dot( const T * x, const C * c, unsigned n )
+{
+	C output = 0;
+
+	for( unsigned i = 0; i < n; ++i ) {
+		output += c[i] * C(x[i]);
+	}
+
+	return output;
+}
+
+} // namespace scalar
+
+#ifdef EXMATH_SIMD_X86
+
+namespace vec {
+
+/*
+ * The kernel bodies are written once with GCC vector extensions and
+ * inlined into the per instruction set wrappers below, which decide
+ * the instructions the compiler may use.
+ */
+
+/**
+ * vectors of the accumulator type C and the matching input vectors of type T
+ */
+template<typename T, typename C, unsigned BYTES>
+struct Vec
+{
+	static constexpr unsigned lanes = BYTES / sizeof(C);
+	typedef C type __attribute__((vector_size(BYTES)));
+	typedef T input_type __attribute__((vector_size(lanes * sizeof(T))));
+	typedef std::conditional_t<sizeof(C) == 4, int32_t, int64_t> index_t;
+	typedef index_t mask_type __attribute__((vector_size(BYTES)));
+};
+
+/**
+ * loads lanes input values and widens them to the accumulator type
+ */
+template<typename T, typename C, unsigned BYTES>
+[[gnu::always_inline]] inline void load( typename Vec<T,C,BYTES>::type & dest, const T * p )
+{
+	typename Vec<T,C,BYTES>::input_type v;
+	__builtin_memcpy( &v, p, sizeof(v) );
+	dest = __builtin_convertvector( v, typename Vec<T,C,BYTES>::type );
+}
+
+template<typename T, typename C, unsigned BYTES>
+[[gnu::always_inline]] inline void folded_block( const T * w, std::size_t stride, const C * cf, unsigned n, C * sums, std::size_t count )
+{
+	typedef typename Vec<T,C,BYTES>::type V;
+	constexpr unsigned L = Vec<T,C,BYTES>::lanes;
+	constexpr unsigned U = 4;
+
+	const unsigned half = n / 2;
+	std::size_t k = 0;
+
+	// U independent accumulators to hide the add latency
+	for( ; k + U * L <= count; k += U * L ) {
+		V acc[U] = {};
+
+		for( unsigned i = 0, j = n-1; i < half; ++i, --j ) {
+			V c = cf[i] - V{};
+
+			for( unsigned u = 0; u < U; ++u ) {
+				V a, b;
+				load<T,C,BYTES>( a, w + k + u * L + i * stride );
+				load<T,C,BYTES>( b, w + k + u * L + j * stride );
+				acc[u] += c * ( b - a );
+			}
+		}
+
+		__builtin_memcpy( sums + k, acc, sizeof(acc) );
+	}
+
+	for( ; k + L <= count; k += L ) {
+		V acc = {};
+
+		for( unsigned i = 0, j = n-1; i < half; ++i, --j ) {
+			V a, b;
+			load<T,C,BYTES>( a, w + k + i * stride );
+			load<T,C,BYTES>( b, w + k + j * stride );
+			acc += ( cf[i] - V{} ) * ( b - a );
+		}
+
+		__builtin_memcpy( sums + k, &acc, sizeof(V) );
+	}
+
+	scalar::folded_block( w + k, stride, cf, n, sums + k, count - k );
+}
+
+template<typename T, typename C, unsigned BYTES>
+[[gnu::always_inline]] inline void folded_block_compensated( const T * w, std::size_t stride, const C * cf, unsigned n,
+															 C * sums, std::size_t count )
+{
+	typedef typename Vec<T,C,BYTES>::type V;
+	constexpr unsigned L = Vec<T,C,BYTES>::lanes;
+	constexpr unsigned U = 4;
+
+	const unsigned half = n / 2;
+	std::size_t k = 0;
+
+	for( ; k + U * L <= count; k += U * L ) {
+		V sum[U] = {};
+		V comp[U] = {};
+
+		for( unsigned i = 0; i < half; i += compensation_block ) {
+			const unsigned end = std::min( i + compensation_block, half );
+			V part[U] = {};
+
+			for( unsigned t = i, j = n-1-i; t < end; ++t, --j ) {
+				V c = cf[t] - V{};
+
+				for( unsigned u = 0; u < U; ++u ) {
+					V a, b;
+					load<T,C,BYTES>( a, w + k + u * L + t * stride );
+					load<T,C,BYTES>( b, w + k + u * L + j * stride );
+					part[u] += c * ( b - a );
+				}
+			}
+
+			for( unsigned u = 0; u < U; ++u ) {
+				scalar::compensated_add( sum[u], comp[u], part[u] );
+			}
+		}
+
+		for( unsigned u = 0; u < U; ++u ) {
+			sum[u] += comp[u];
+		}
+
+		__builtin_memcpy( sums + k, sum, sizeof(sum) );
+	}
+
+	for( ; k + L <= count; k += L ) {
+		V sum = {};
+		V comp = {};
+
+		for( unsigned i = 0; i < half; i += compensation_block ) {
+			const unsigned end = std::min( i + compensation_block, half );
+			V part = {};
+
+			for( unsigned t = i, j = n-1-i; t < end; ++t, --j ) {
+				V a, b;
+				load<T,C,BYTES>( a, w + k + t * stride );
+				load<T,C,BYTES>( b, w + k + j * stride );
+				part += ( cf[t] - V{} ) * ( b - a );
+			}
+
+			scalar::compensated_add( sum, comp, part );
+		}
+
+		sum += comp;
+		__builtin_memcpy( sums + k, &sum, sizeof(V) );
+	}
+
+	scalar::folded_block_compensated( w + k, stride, cf, n, sums + k, count - k );
+}
+
+template<typename T, typename C, unsigned BYTES>
+[[gnu::always_inline]] inline void fir_block( const T * w, const C * cf, unsigned n, C * sums, std::size_t count )
+{
+	typedef typename Vec<T,C,BYTES>::type V;
+	constexpr unsigned L = Vec<T,C,BYTES>::lanes;
+	constexpr unsigned U = 4;
+
+	std::size_t k = 0;
+
+	for( ; k + U * L <= count; k += U * L ) {
+		V acc[U] = {};
+
+		for( unsigned i = 0; i < n; ++i ) {
+			V c = cf[i] - V{};
+
+			for( unsigned u = 0; u < U; ++u ) {
+				V a;
+				load<T,C,BYTES>( a, w + k + u * L + i );
+				acc[u] += c * a;
+			}
+		}
+
+		__builtin_memcpy( sums + k, acc, sizeof(acc) );
+	}
+
+	for( ; k + L <= count; k += L ) {
+		V acc = {};
+
+		for( unsigned i = 0; i < n; ++i ) {
+			V a;
+			load<T,C,BYTES>( a, w + k + i );
+			acc += ( cf[i] - V{} ) * a;
+		}
+
+		__builtin_memcpy( sums + k, &acc, sizeof(V) );
+	}
+
+	scalar::fir_block( w + k, cf, n, sums + k, count - k );
+}
+
+template<typename T, typename C, unsigned BYTES>
+[[gnu::always_inline]] inline void fused_block( const T * w, const C * even0, const C * odd, const C * even1, unsigned n,
+												C * sums0, C * sums1, C * sums2, std::size_t count )
+{
+	typedef typename Vec<T,C,BYTES>::type V;
+	constexpr unsigned L = Vec<T,C,BYTES>::lanes;
+
+	const unsigned half = n / 2;
+	std::size_t k = 0;
+
+	// three independent accumulators already hide the add latency
+	for( ; k + L <= count; k += L ) {
+		V s0 = {};
+		V s1 = {};
+		V s2 = {};
+
+		for( unsigned i = 0, j = n-1; i < half; ++i, --j ) {
+			V a, b;
+			load<T,C,BYTES>( a, w + k + i );
+			load<T,C,BYTES>( b, w + k + j );
+
+			const V p = b + a;
+			const V d = b - a;
+
+			s0 += ( even0[i] - V{} ) * p;
+			s1 += ( odd[i] - V{} ) * d;
+			s2 += ( even1[i] - V{} ) * p;
+		}
+
+		V center;
+		load<T,C,BYTES>( center, w + k + half );
+
+		s0 += ( even0[half] - V{} ) * center;
+		s2 += ( even1[half] - V{} ) * center;
+
+		__builtin_memcpy( sums0 + k, &s0, sizeof(V) );
+		__builtin_memcpy( sums1 + k, &s1, sizeof(V) );
+		__builtin_memcpy( sums2 + k, &s2, sizeof(V) );
+	}
+
+	scalar::fused_block( w + k, even0, odd, even1, n, sums0 + k, sums1 + k, sums2 + k, count - k );
+}
+
+template<typename T, typename C, unsigned BYTES>
+[[gnu::always_inline]] inline C folded_sum( const T * w, const C * cf, unsigned n )
+{
+	typedef typename Vec<T,C,BYTES>::type V;
+	typedef typename Vec<T,C,BYTES>::mask_type M;
+	constexpr unsigned L = Vec<T,C,BYTES>::lanes;
+
+	M reverse;
+	for( unsigned l = 0; l < L; ++l ) {
+		reverse[l] = L - 1 - l;
+	}
+
+	const unsigned half = n / 2;
+	V acc = {};
+	unsigned i = 0;
+
+	for( ; i + L <= half; i += L ) {
+		V a, b, c;
+		load<T,C,BYTES>( a, w + i );
+		load<T,C,BYTES>( b, w + n - i - L );
+		__builtin_memcpy( &c, cf + i, sizeof(V) );
+		acc += c * ( __builtin_shuffle( b, reverse ) - a );
+	}
+
+	C output = 0;
+
+	for( unsigned l = 0; l < L; ++l ) {
+		output += acc[l];
+	}
+
+	for( unsigned j = n - 1 - i; i < half; ++i, --j ) {
+		output += cf[i] * ( C(w[j]) - C(w[i]) );
+	}
+
+	return output;
+}
+
+template<typename T, typename C, unsigned BYTES>
+[[gnu::always_inline]] inline C dot( const T * x, const C * c, unsigned n )
+{
+	typedef typename Vec<T,C,BYTES>::type V;
+	constexpr unsigned L = Vec<T,C,BYTES>::lanes;
+	constexpr unsigned U = 4;
+
+	V acc[U] = {};
+	unsigned i = 0;
+
+	for( ; i + U * L <= n; i += U * L ) {
+		for( unsigned u = 0; u < U; ++u ) {
+			V a, b;
+			load<T,C,BYTES>( a, x + i + u * L );
+			__builtin_memcpy( &b, c + i + u * L, sizeof(V) );
+			acc[u] += a * b;
+		}
+	}
+
+	for( ; i + L <= n; i += L ) {
+		V a, b;
+		load<T,C,BYTES>( a, x + i );
+		__builtin_memcpy( &b, c + i, sizeof(V) );
+		acc[0] += a * b;
+	}
+
+	V total = ( acc[0] + acc[1] ) + ( acc[2] + acc[3] );
+	C output = 0;
+
+	for( unsigned l = 0; l < L; ++l ) {
+		output += total[l];
+	}
+
+	for( ; i < n; ++i ) {
+		output += c[i] * C(x[i]);
+	}
+
+	return output;
+}
+
+} // namespace vec
+
+/*
+ * fp-contract=off: a fused multiply add rounds differently than
+ * the scalar code, which would break the bit identical lane results.
+ */
+#define EXMATH_SIMD_WRAPPERS( NAME, TARGET, BYTES ) \
+	namespace NAME { \
+		template<typename T, typename C> \
+		__attribute__((target(TARGET),optimize("fp-contract=off"))) \
+		void folded_block( const T * w, std::size_t stride, const C * cf, unsigned n, C * sums, std::size_t count ) { \
+			vec::folded_block<T,C,BYTES>( w, stride, cf, n, sums, count ); \
+		} \
+		template<unsigned N, typename T, typename C> \
+		__attribute__((target(TARGET),optimize("fp-contract=off"))) \
+		void folded_block_fixed( const T * w, const C * cf, C * sums, std::size_t count ) { \
+			vec::folded_block<T,C,BYTES>( w, 1, cf, N, sums, count ); \
+		} \
+		template<typename T, typename C> \
+		__attribute__((target(TARGET),optimize("fp-contract=off"))) \
+		void folded_block_compensated( const T * w, std::size_t stride, const C * cf, unsigned n, C * sums, std::size_t count ) { \
+			vec::folded_block_compensated<T,C,BYTES>( w, stride, cf, n, sums, count ); \
+		} \
+		template<typename T, typename C> \
+		__attribute__((target(TARGET),optimize("fp-contract=off"))) \
+		void fir_block( const T * w, const C * cf, unsigned n, C * sums, std::size_t count ) { \
+			vec::fir_block<T,C,BYTES>( w, cf, n, sums, count ); \
+		} \
+		template<typename T, typename C> \
+		__attribute__((target(TARGET),optimize("fp-contract=off"))) \
+		void fused_block( const T * w, const C * even0, const C * odd, const C * even1, unsigned n, \
+						  C * sums0, C * sums1, C * sums2, std::size_t count ) { \
+			vec::fused_block<T,C,BYTES>( w, even0, odd, even1, n, sums0, sums1, sums2, count ); \
+		} \
+		template<typename T, typename C> \
+		__attribute__((target(TARGET),optimize("fp-contract=off"))) \
+		C folded_sum( const T * w, const C * cf, unsigned n ) { \
+			return vec::folded_sum<T,C,BYTES>( w, cf, n ); \
+		} \
+		template<typename T, typename C> \
+		__attribute__((target(TARGET),optimize("fp-contract=off"))) \
+		C dot( const T * x, const C * c, unsigned n ) { \
+			return vec::dot<T,C,BYTES>( x, c, n ); \
+		} \
+	}
+
+EXMATH_SIMD_WRAPPERS( sse42,  "sse4.2", 16 )
+EXMATH_SIMD_WRAPPERS( avx2,   "avx2", 32 )
+EXMATH_SIMD_WRAPPERS( avx512, "avx512f,avx512dq", 64 )
+
+#undef EXMATH_SIMD_WRAPPERS
+
+#endif // EXMATH_SIMD_X86
+
+template<typename T, typename C>
+struct Kernels
+{
+	void (*folded_block)( const T * w, std::size_t stride, const C * cf, unsigned n, C * sums, std::size_t count );
+	void (*folded_block_compensated)( const T * w, std::size_t stride, const C * cf, unsigned n, C * sums, std::size_t count );
+	void (*fir_block)( const T * w, const C * cf, unsigned n, C * sums, std::size_t count );
+	void (*fused_block)( const T * w, const C * even0, const C * odd, const C * even1, unsigned n,
+						 C * sums0, C * sums1, C * sums2, std::size_t count );
+	C    (*folded_sum)( const T * w, const C * cf, unsigned n );
+	C    (*dot)( const T * x, const C * c, unsigned n );
+};
+
+/**
+ * returns the kernel table for a specific instruction set
+ */
+template<typename T, typename C = T>
+requires supported_pair<T,C>
+const Kernels<T,C> & kernels_for( ISA isa )
+{
+	static const std::array<Kernels<T,C>, ISA_COUNT> table = {
+		Kernels<T,C>{ scalar::folded_block<T,C>, scalar::folded_block_compensated<T,C>, scalar::fir_block<T,C>, scalar::fused_block<T,C>, scalar::folded_sum<T,C>, scalar::dot<T,C> },
+#ifdef EXMATH_SIMD_X86
+		Kernels<T,C>{ sse42::folded_block<T,C>, sse42::folded_block_compensated<T,C>, sse42::fir_block<T,C>, sse42::fused_block<T,C>, sse42::folded_sum<T,C>, sse42::dot<T,C> },
+		Kernels<T,C>{ avx2::folded_block<T,C>, avx2::folded_block_compensated<T,C>, avx2::fir_block<T,C>, avx2::fused_block<T,C>, avx2::folded_sum<T,C>, avx2::dot<T,C> },
+		Kernels<T,C>{ avx512::folded_block<T,C>, avx512::folded_block_compensated<T,C>, avx512::fir_block<T,C>, avx512::fused_block<T,C>, avx512::folded_sum<T,C>, avx512::dot<T,C> },
+#else
+		Kernels<T,C>{ scalar::folded_block<T,C>, scalar::folded_block_compensated<T,C>, scalar::fir_block<T,C>, scalar::fused_block<T,C>, scalar::folded_sum<T,C>, scalar::dot<T,C> },
+		Kernels<T,C>{ scalar::folded_block<T,C>, scalar::folded_block_compensated<T,C>, scalar::fir_block<T,C>, scalar::fused_block<T,C>, scalar::folded_sum<T,C>, scalar::dot<T,C> },
+		Kernels<T,C>{ scalar::folded_block<T,C>, scalar::folded_block_compensated<T,C>, scalar::fir_block<T,C>, scalar::fused_block<T,C>, scalar::folded_sum<T,C>, scalar::dot<T,C> },
+#endif
+	};
+
+	return table[static_cast<unsigned>(isa)];
+}
+
+template<typename T, typename C>
+requires supported_pair<T,C>
+void folded_block( const T * w, std::size_t stride, const C * cf, unsigned n, C * sums, std::size_t count )
+{
+	kernels_for<T,C>( active_isa() ).folded_block( w, stride, cf, n, sums, count );
+}
+
+template<typename T, typename C>
+requires supported_pair<T,C>
+void folded_block( const T * w, const C * cf, unsigned n, C * sums, std::size_t count )
+{
+	folded_block( w, 1, cf, n, sums, count );
+}
+
+template<typename T, typename C>
+requires supported_pair<T,C>
+void folded_block_compensated( const T * w, std::size_t stride, const C * cf, unsigned n, C * sums, std::size_t count )
+{
+	kernels_for<T,C>( active_isa() ).folded_block_compensated( w, stride, cf, n, sums, count );
+}
+
+template<typename T, typename C>
+requires supported_pair<T,C>
+void folded_block_compensated( const T * w, const C * cf, unsigned n, C * sums, std::size_t count )
+{
+	folded_block_compensated( w, 1, cf, n, sums, count );
+}
+
+template<typename T, typename C>
+requires supported_pair<T,C>
+void fir_block( const T * w, const C * cf, unsigned n, C * sums, std::size_t count )
+{
+	kernels_for<T,C>( active_isa() ).fir_block( w, cf, n, sums, count );
+}
+
+template<typename T, typename C>
+requires supported_pair<T,C>
+void fused_block( const T * w, const C * even0, const C * odd, const C * even1, unsigned n,
+				  C * sums0, C * sums1, C * sums2, std::size_t count )
+{
+	kernels_for<T,C>( active_isa() ).fused_block( w, even0, odd, even1, n, sums0, sums1, sums2, count );
+}
+
+template<typename T, typename C>
+using FixedBlockKernel = void (*)( const T * w, const C * cf, C * sums, std::size_t count );
+
+/**
+ * returns folded_block_fixed<N>() for a specific instruction set
+ */
+template<unsigned N, typename T, typename C = T>
+requires supported_pair<T,C>
+FixedBlockKernel<T,C> fixed_kernel_for( ISA isa )
+{
+	static const std::array<FixedBlockKernel<T,C>, ISA_COUNT> table = {
+		scalar::folded_block_fixed<N,T,C>,
+#ifdef EXMATH_SIMD_X86
+		sse42::folded_block_fixed<N,T,C>,
+		avx2::folded_block_fixed<N,T,C>,
+		avx512::folded_block_fixed<N,T,C>,
+#else
+		scalar::folded_block_fixed<N,T,C>,
+		scalar::folded_block_fixed<N,T,C>,
+		scalar::folded_block_fixed<N,T,C>,
+#endif
+	};
+
+	return table[static_cast<unsigned>(isa)];
+}
+
+template<unsigned N, typename T, typename C>
+requires supported_pair<T,C>
+void folded_block_fixed( const T * w, const C * cf, C * sums, std::size_t count )
+{
+	fixed_kernel_for<N,T,C>( active_isa() )( w, cf, sums, count );
+}
+
+template<typename T, typename C>
+requires supported_pair<T,C>
+C folded_sum( const T * w, const C * cf, unsigned n )
+{
+	return kernels_for<T,C>( active_isa() ).folded_sum( w, cf, n );
+}
+
+template<typename T, typename C>
+requires supported_pair<T,C>
+C dot( const T * x, const C * c, unsigned n )
+{
+	return kernels_for<T,C>( active_isa() ).dot( x, c, n );
+}
+
+namespace internal {
+
+	template<typename T, typename C>
+	requires supported_pair<T,C>
+	bool verify_kernels( ISA isa )
+	{
+		const Kernels<T,C> & ref = kernels_for<T,C>( ISA::scalar );
+		const Kernels<T,C> & k = kernels_for<T,C>( isa );
+
+		constexpr unsigned MAX_N = 131;
+		constexpr unsigned MAX_COUNT = 77;
+
+		std::array<T, 3 * MAX_N + MAX_COUNT> w{};
+		std::array<C, MAX_N> cf{};
+
+		// small values, so the integer sums can't overflow
+		uint32_t seed = 4711;
+		auto next = [&seed]() {
+			seed = seed * 1103515245 + 12345;
+			return int( ( seed >> 16 ) % 2001 ) - 1000;
+		};
+
+		for( auto & x : w ) {
+			x = T( next() );
+		}
+
+		for( auto & c : cf ) {
+			c = C( next() );
+		}
+
+		for( unsigned n = 1; n <= MAX_N; n += 2 ) {
+
+			for( unsigned count = 0; count <= MAX_COUNT; count += 7 ) {
+				std::array<C, MAX_COUNT> expected{};
+				std::array<C, MAX_COUNT> result{};
+
+				// stride 1: consecutive outputs, stride 3: channels side by side
+				for( std::size_t stride : { 1, 3 } ) {
+					if( ( n - 1 ) * stride + count > w.size() ) {
+						continue;
+					}
+
+					ref.folded_block( w.data(), stride, cf.data(), n, expected.data(), count );
+					k.folded_block( w.data(), stride, cf.data(), n, result.data(), count );
+
+					if( expected != result ) {
+						return false;
+					}
+
+					ref.folded_block_compensated( w.data(), stride, cf.data(), n, expected.data(), count );
+					k.folded_block_compensated( w.data(), stride, cf.data(), n, result.data(), count );
+
+					if( expected != result ) {
+						return false;
+					}
+				}
+
+				ref.fir_block( w.data(), cf.data(), n, expected.data(), count );
+				k.fir_block( w.data(), cf.data(), n, result.data(), count );
+
+				if( expected != result ) {
+					return false;
+				}
+
+				if( n == 5 || n == 27 ) {
+					ref.folded_block( w.data(), 1, cf.data(), n, expected.data(), count );
+
+					if( n == 5 ) {
+						fixed_kernel_for<5,T,C>( isa )( w.data(), cf.data(), result.data(), count );
+					} else {
+						fixed_kernel_for<27,T,C>( isa )( w.data(), cf.data(), result.data(), count );
+					}
+
+					if( expected != result ) {
+						return false;
+					}
+				}
+
+				std::array<std::array<C, MAX_COUNT>, 3> expected_fused{};
+				std::array<std::array<C, MAX_COUNT>, 3> fused{};
+
+				ref.fused_block( w.data(), cf.data(), cf.data() + 1, cf.data() + 2, n,
+								 expected_fused[0].data(), expected_fused[1].data(), expected_fused[2].data(), count );
+				k.fused_block( w.data(), cf.data(), cf.data() + 1, cf.data() + 2, n,
+							   fused[0].data(), fused[1].data(), fused[2].data(), count );
+
+				if( expected_fused != fused ) {
+					return false;
+				}
+			}
+
+			C expected_sum = ref.folded_sum( w.data(), cf.data(), n );
+			C sum = k.folded_sum( w.data(), cf.data(), n );
+
+			C expected_dot = ref.dot( w.data(), cf.data(), n );
+			C dot = k.dot( w.data(), cf.data(), n );
+
+			if constexpr( std::is_integral_v<C> ) {
+				if( expected_sum != sum || expected_dot != dot ) {
+					return false;
+				}
+			} else {
+				// only the summation order differs, the terms are exact
+				C bound = 0;
+				for( unsigned i = 0; i < n; ++i ) {
+					bound += std::abs( cf[i] ) * ( std::abs( C(w[i]) ) + std::abs( C(w[n-1-i]) ) );
+				}
+
+				bound *= n * std::numeric_limits<C>::epsilon();
+
+				if( std::abs( expected_sum - sum ) > bound || std::abs( expected_dot - dot ) > bound ) {
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+} // namespace internal
+
+/**
+ * Checks all kernels of the given instruction set against the
+ * scalar reference kernels.
+ */
+inline bool verify_kernels( ISA isa )
+{
+	return internal::verify_kernels<float,float>( isa )
+		&& internal::verify_kernels<double,double>( isa )
+		&& internal::verify_kernels<int32_t,int32_t>( isa )
+		&& internal::verify_kernels<int64_t,int64_t>( isa )
+		&& internal::verify_kernels<int16_t,int32_t>( isa )
+		&& internal::verify_kernels<int16_t,int64_t>( isa )
+		&& internal::verify_kernels<int32_t,int64_t>( isa )
+		&& internal::verify_kernels<float,double>( isa );
+}
+
+} // namespace exmath::Filter::simd
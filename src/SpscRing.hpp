@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * Wait free single producer / single consumer ring buffer.
+ *
+ * One thread pushes, one other thread pops. Neither ever blocks or
+ * retries, push() and pop() transfer as many values as fit and return
+ * the count. The write and the read position live on their own cache
+ * lines, each side keeps a private copy of the other side's position
+ * and only reloads it when the ring looks full or empty.
+ *
+ * SpscRing<int32_t> ring( 4096 );
+ *
+ * producer: if( !ring.push( adc_value ) ) { overrun... }
+ * consumer: std::size_t n = ring.pop( block );
+ */
+
+namespace exmath::Filter {
+
+template <typename T>
+class SpscRing
+{
+public:
+	static constexpr std::size_t cache_line = 64;
+
+private:
+	struct alignas(cache_line) ProducerSide
+	{
+		std::atomic<std::size_t> head{ 0 };   // next write position, written by the producer
+		std::size_t cached_tail = 0;          // last seen read position
+	};
+
+	struct alignas(cache_line) ConsumerSide
+	{
+		std::atomic<std::size_t> tail{ 0 };   // next read position, written by the consumer
+		std::size_t cached_head = 0;          // last seen write position
+	};
+
+	const std::size_t mask;
+	std::vector<T> buffer;
+
+	ProducerSide producer;
+	ConsumerSide consumer;
+
+public:
+	/**
+	 * the capacity is rounded up to a power of two
+	 */
+	explicit SpscRing( std::size_t capacity_ )
+	: mask( check_capacity( capacity_ ) - 1 ),
+	  buffer( mask + 1 )
+	{
+	}
+
+	SpscRing( const SpscRing & other ) = delete;
+	SpscRing & operator=( const SpscRing & other ) = delete;
+
+	std::size_t capacity() const {
+		return mask + 1;
+	}
+
+	/**
+	 * Producer only. Appends as many values as fit, returns their number.
+	 */
+	std::size_t push( std::span<const T> values )
+	{
+		const std::size_t head = producer.head.load( std::memory_order_relaxed );
+
+		if( capacity() - ( head - producer.cached_tail ) < values.size() ) {
+			producer.cached_tail = consumer.tail.load( std::memory_order_acquire );
+		}
+
+		const std::size_t count = std::min( values.size(), capacity() - ( head - producer.cached_tail ) );
+		const std::size_t pos = head & mask;
+		const std::size_t first = std::min( count, capacity() - pos );
+
+		std::copy_n( values.begin(), first, buffer.begin() + pos );
+		std::copy_n( values.begin() + first, count - first, buffer.begin() );
+
+		producer.head.store( head + count, std::memory_order_release );
+
+		return count;
+	}
+
+	/**
+	 * Producer only. false if the ring is full.
+	 */
+	bool push( const T & value ) {
+		return push( std::span<const T>( &value, 1 ) ) == 1;
+	}
+
+	/**
+	 * Consumer only. Fills values from the beginning, returns the number of values.
+	 */
+	std::size_t pop( std::span<T> values )
+	{
+		const std::size_t tail = consumer.tail.load( std::memory_order_relaxed );
+
+		if( consumer.cached_head - tail < values.size() ) {
+			consumer.cached_head = producer.head.load( std::memory_order_acquire );
+		}
+
+		const std::size_t count = std::min( values.size(), consumer.cached_head - tail );
+		const std::size_t pos = tail & mask;
+		const std::size_t first = std::min( count, capacity() - pos );
+
+		std::copy_n( buffer.begin() + pos, first, values.begin() );
+		std::copy_n( buffer.begin(), count - first, values.begin() + first );
+
+		consumer.tail.store( tail + count, std::memory_order_release );
+
+		return count;
+	}
+
+	/**
+	 * Number of values in the ring. Exact for the calling side,
+	 * the other side may have moved on already.
+	 */
+	std::size_t size() const
+	{
+		const std::size_t tail = consumer.tail.load( std::memory_order_acquire );
+		const std::size_t head = producer.head.load( std::memory_order_acquire );
+
+		return head - tail;
+	}
+
+	bool empty() const {
+		return size() == 0;
+	}
+
+private:
+	static std::size_t check_capacity( std::size_t capacity )
+	{
+		if( capacity == 0 || capacity > ( std::size_t(1) << ( sizeof(std::size_t) * 8 - 2 ) ) ) {
+			throw std::invalid_argument("Invalid ring capacity.");
+		}
+
+		return std::bit_ceil( capacity );
+	}
+};
+
+} // namespace exmath::Filter
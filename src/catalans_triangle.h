@@ -1,8 +1,11 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <limits>
 #include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 /*
 	http://www.holoborodko.com/pavel/numerical-methods/numerical-derivative/smooth-low-noise-differentiators/
@@ -20,6 +23,16 @@
             for k in range(1, h, 1) : D[k] += D[k+1]
         b = not b
         if b : print([D[z] for z in (1..h-1) ])
+
+	The simulation above needs O(n^2) additions. Element k of line n has
+	the closed form
+
+	  D[k] = C(2n-2, n-1-k) - C(2n-2, n-3-k)
+
+	and consecutive binomial coefficients follow from each other by one
+	multiplication and one division, so the whole line takes O(n) steps.
+	The binomials are calculated exactly with a multiword integer and
+	rounded only once when converted to the coefficient type.
 */
 
 /*
@@ -52,45 +65,269 @@
 377 1
  */
 
-template<typename T, unsigned n>
-constexpr std::array<T,n> calc_last_line_of_catalan_triangle()
+namespace exmath::Filter::SNRDFir::internal {
+
+/**
+ * Fixed size unsigned integer for the exact binomial coefficients,
+ * LIMBS 64 bit words, least significant first.
+ */
+template<unsigned LIMBS>
+class BigUInt
 {
-  std::array<T,n+2> D{0};
+	std::array<uint64_t, LIMBS> limbs{};
+
+public:
+	constexpr BigUInt( uint64_t value = 0 ) {
+		limbs[0] = value;
+	}
+
+	constexpr BigUInt & operator*=( uint64_t factor )
+	{
+		unsigned __int128 carry = 0;
+
+		for( uint64_t & limb : limbs ) {
+			carry += static_cast<unsigned __int128>( limb ) * factor;
+			limb = static_cast<uint64_t>( carry );
+			carry >>= 64;
+		}
+
+		if( carry != 0 ) {
+			throw std::overflow_error("Overflow error. BigUInt too small.");
+		}
+
+		return *this;
+	}
+
+	/**
+	 * exact division only, the remainder is dropped
+	 */
+	constexpr BigUInt & operator/=( uint64_t divisor )
+	{
+		unsigned __int128 rest = 0;
+
+		for( unsigned i = LIMBS; i-- > 0; ) {
+			rest = ( rest << 64 ) | limbs[i];
+			limbs[i] = static_cast<uint64_t>( rest / divisor );
+			rest %= divisor;
+		}
+
+		return *this;
+	}
+
+	constexpr BigUInt & operator+=( const BigUInt & other )
+	{
+		uint64_t carry = 0;
+
+		for( unsigned i = 0; i < LIMBS; ++i ) {
+			const uint64_t a = limbs[i];
+			limbs[i] = a + other.limbs[i] + carry;
+			carry = ( limbs[i] < a || ( limbs[i] == a && carry ) ) ? 1 : 0;
+		}
+
+		if( carry != 0 ) {
+			throw std::overflow_error("Overflow error. BigUInt too small.");
+		}
+
+		return *this;
+	}
+
+	friend constexpr bool operator<( const BigUInt & a, const BigUInt & b )
+	{
+		for( unsigned i = LIMBS; i-- > 0; ) {
+			if( a.limbs[i] != b.limbs[i] ) {
+				return a.limbs[i] < b.limbs[i];
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * requires *this >= other
+	 */
+	constexpr BigUInt & operator-=( const BigUInt & other )
+	{
+		uint64_t borrow = 0;
+
+		for( unsigned i = 0; i < LIMBS; ++i ) {
+			const uint64_t a = limbs[i];
+			const uint64_t b = other.limbs[i];
+			limbs[i] = a - b - borrow;
+			borrow = ( a < b || ( a == b && borrow ) ) ? 1 : 0;
+		}
+
+		return *this;
+	}
+
+	constexpr unsigned bit_width() const
+	{
+		for( unsigned i = LIMBS; i-- > 0; ) {
+			if( limbs[i] != 0 ) {
+				unsigned bits = 0;
+
+				for( uint64_t v = limbs[i]; v != 0; v >>= 1 ) {
+					++bits;
+				}
+
+				return i * 64 + bits;
+			}
+		}
+
+		return 0;
+	}
+
+	constexpr bool bit( unsigned pos ) const {
+		return ( limbs[pos / 64] >> ( pos % 64 ) ) & 1;
+	}
+
+	/**
+	 * 64 bits starting at bit pos
+	 */
+	constexpr uint64_t bits_at( unsigned pos ) const
+	{
+		const unsigned i = pos / 64;
+		const unsigned shift = pos % 64;
 
-  bool b = true;
-  int h = 1;
-  D.at(1) = 1;
+		uint64_t value = limbs[i] >> shift;
 
-  for( int i = 0; i < 2 * int(n); ++i ) {
-    if( b ) {
-      for( int k = h; k > 0; --k ) {
+		if( shift != 0 && i + 1 < LIMBS ) {
+			value |= limbs[i+1] << ( 64 - shift );
+		}
 
-        if( std::numeric_limits<T>::max() - D.at(k-1) < D.at(k) ) {
-          throw std::overflow_error("Overflow error. Coefficient not possible with this datatype.");
-        }
+		return value;
+	}
 
-        D.at(k) += D.at(k-1);
-      }
-      h += 1;
-    } else {
-      for( int k = 1; k < h; ++k ) {
+	/**
+	 * Integer types get the exact value, floating point types
+	 * the correctly rounded one. Throws if it does not fit.
+	 *
+	 * Floating point types can get the value times 2^exp2 instead,
+	 * correctly rounded as long as that is a normal number.
+	 */
+	template<typename T>
+	constexpr T to( int exp2 = 0 ) const
+	{
+		const unsigned width = bit_width();
 
-        if( std::numeric_limits<T>::max() - D.at(k+1) < D.at(k) ) {
-          throw std::overflow_error("Overflow error. Coefficient not possible with this datatype.");
-        }
+		if constexpr( std::is_integral_v<T> ) {
+			if( width > std::numeric_limits<T>::digits || exp2 != 0 ) {
+				throw std::overflow_error("Overflow error. Coefficient not possible with this datatype.");
+			}
 
-        D.at(k) += D.at(k+1);
-      }
-    }
+			return static_cast<T>( limbs[0] );
+		} else {
+			if( width <= 64 ) {
+				return scale<T>( static_cast<T>( limbs[0] ), exp2 );
+			}
 
-    b = !b;
-  }
+			// the top 64 bits, the lowest one set if any bit below is set,
+			// round exactly like the full value (64 > mantissa + 2 bits)
+			const unsigned shift = width - 64;
+			uint64_t top = bits_at( shift );
 
-  std::array<T,n> ret{0};
+			for( unsigned pos = 0; pos < shift && !( top & 1 ); ++pos ) {
+				if( bit( pos ) ) {
+					top |= 1;
+				}
+			}
 
-  for( int z = 1,i = 0; z < h; ++z, ++i ) {
-    ret.at(i) = D.at(z);
-  }
+			return scale<T>( static_cast<T>( top ), static_cast<int>( shift ) + exp2 );
+		}
+	}
 
-  return ret;
+private:
+	/**
+	 * value * 2^exp2, exact unless the result is subnormal
+	 */
+	template<typename T>
+	static constexpr T scale( T value, int exp2 )
+	{
+		for( ; exp2 > 0; --exp2 ) {
+			if( value > std::numeric_limits<T>::max() / 2 ) {
+				throw std::overflow_error("Overflow error. Coefficient not possible with this datatype.");
+			}
+
+			value *= 2;
+		}
+
+		for( ; exp2 < 0; ++exp2 ) {
+			value /= 2;
+		}
+
+		return value;
+	}
+};
+
+/**
+ * Writes the last line of the catalan triangle for n into ret,
+ * for floating point types optionally times 2^exp2.
+ * LIMBS has to hold 2n-2+32 bits.
+ */
+template<typename T, unsigned LIMBS>
+constexpr void calc_last_line_of_catalan_triangle( unsigned n, T * ret, int exp2 = 0 )
+{
+	if( n == 0 ) {
+		return;
+	}
+
+	typedef BigUInt<LIMBS> Int;
+
+	const unsigned m = 2 * n - 2;
+
+	// binomial C(m,j) and the two before it
+	Int c = 1;
+	Int c1 = 0;
+	Int c2 = 0;
+
+	for( unsigned j = 0; j < n; ++j ) {
+		Int element = c;
+		element -= c2;
+		ret[n-1-j] = element.template to<T>( exp2 );
+
+		c2 = c1;
+		c1 = c;
+		c *= m - j;
+		c /= j + 1;
+	}
+}
+
+/*
+ * Calcualates the last line of the catalan triangle
+ */
+template<typename T, unsigned n>
+constexpr std::array<T,n> calc_last_line_of_catalan_triangle( int exp2 = 0 )
+{
+	std::array<T,n> ret{};
+
+	// C(m,j) < 2^m, plus room for the factor before the division
+	constexpr unsigned limbs = ( 2 * n + 30 ) / 64 + 1;
+
+	calc_last_line_of_catalan_triangle<T,limbs>( n, ret.data(), exp2 );
+
+	return ret;
+}
+
+/**
+ * Same for an n only known at runtime
+ */
+template<typename T>
+std::vector<T> calc_last_line_of_catalan_triangle( unsigned n, int exp2 = 0 )
+{
+	std::vector<T> ret( n );
+
+	const unsigned limbs = ( 2 * n + 30 ) / 64 + 1;
+
+	if( limbs <= 4 ) {
+		calc_last_line_of_catalan_triangle<T,4>( n, ret.data(), exp2 );
+	} else if( limbs <= 32 ) {
+		calc_last_line_of_catalan_triangle<T,32>( n, ret.data(), exp2 );
+	} else if( limbs <= 512 ) {
+		calc_last_line_of_catalan_triangle<T,512>( n, ret.data(), exp2 );
+	} else {
+		throw std::overflow_error("Overflow error. Coefficient not possible with this datatype.");
+	}
+
+	return ret;
 }
+
+} // namespace exmath::Filter::SNRDFir::internal
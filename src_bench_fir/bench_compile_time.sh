@@ -0,0 +1,82 @@
+#!/usr/bin/env bash
+#
+# Measures how long the compile time coefficient generation takes.
+#
+# Every filter length is compiled in its own translation unit, which
+# forces Filter<TYPE,TYPE,N>::get_coefficients() through constexpr evaluation.
+#
+#   bench_compile_time.sh [-r baseline_revision] [-t type] [N ...]
+#
+#   bench_compile_time.sh -r HEAD~1 127 397 795
+#
+# With -r the same lengths are compiled against the headers of the
+# given git revision too. CXX and CXXFLAGS are taken from the environment.
+
+set -e
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=gnu++23 -O0}
+TYPE=double
+BASELINE=
+
+while getopts "r:t:" opt; do
+	case $opt in
+		r) BASELINE=$OPTARG ;;
+		t) TYPE=$OPTARG ;;
+		*) exit 1 ;;
+	esac
+done
+
+shift $((OPTIND - 1))
+
+LENGTHS=${*:-"27 127 255 397 795 1001"}
+
+TOP=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+if [ -n "$BASELINE" ]; then
+	mkdir "$WORK/baseline"
+	git -C "$TOP" archive "$BASELINE" src | tar -x -C "$WORK/baseline"
+fi
+
+# prints the seconds one compilation takes, or "failed"
+compile_time()
+{
+	local include=$1
+	local n=$2
+
+	cat > "$WORK/ct.cc" <<EOF
+#include <cstdint>
+#include "SNRDFir.hpp"
+constexpr auto c = exmath::Filter::SNRDFir::Filter<$TYPE,$TYPE,$n>::get_coefficients();
+int main() { return c[$n - 1] != 0 ? 0 : 1; }
+EOF
+
+	local start end
+	start=$(date +%s.%N)
+
+	if $CXX $CXXFLAGS -I"$include" -c "$WORK/ct.cc" -o "$WORK/ct.o" > "$WORK/log" 2>&1; then
+		end=$(date +%s.%N)
+		awk -v s="$start" -v e="$end" 'BEGIN { printf "%.2f", e - s }'
+	else
+		echo -n "failed"
+	fi
+}
+
+if [ -n "$BASELINE" ]; then
+	printf "%8s %12s %12s\n" "N" "current" "$BASELINE"
+else
+	printf "%8s %12s\n" "N" "current"
+fi
+
+for n in $LENGTHS; do
+	current=$(compile_time "$TOP/src" "$n")
+
+	if [ -n "$BASELINE" ]; then
+		base=$(compile_time "$WORK/baseline/src" "$n")
+		printf "%8s %12s %12s\n" "$n" "$current" "$base"
+	else
+		printf "%8s %12s\n" "$n" "$current"
+	fi
+done
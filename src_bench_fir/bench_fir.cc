@@ -0,0 +1,729 @@
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include <ColoredOutput.h>
+#include <OutDebug.h>
+#include <arg.h>
+#include <stderr_exception.h>
+#include <format.h>
+#include "ColBuilder.h"
+#include "SNRDFir.hpp"
+#include "SNRDDynamic.hpp"
+#include "SNRDNormalized.hpp"
+#include "SNRDCompensated.hpp"
+#include "SNRDTruncated.hpp"
+#include "SNRDView.hpp"
+#include "FFTConvolution.hpp"
+#include "SNRDCascade.hpp"
+#include "SNRDFilterBank.hpp"
+#include "SNRDFactory.hpp"
+#include "SNRDMultiOrder.hpp"
+#include "SNRDMultiWindow.hpp"
+#include "SNRDPipeline.hpp"
+#include "SNRDOneSided.hpp"
+#include "FirFilter.hpp"
+
+/*
+ * Measures the throughput of the filters for all supported
+ * sample types, tap counts, APIs and SIMD kernels.
+ *
+ * The default rows use the mirrored delay line, the rows named
+ * Filter/masked and Filter/shift the other delay line policies.
+ * In the TruncatedFilter rows the number after the slash is the number
+ * of taps kept of the N taps filter, in the BlockFilter rows the smallest
+ * block size calibrate() measured for the FFT engine, 0 if it never uses it.
+ * In the FilterBank rows it is the number of channels, the time is per
+ * sample of one channel. The make_filter rows name the input bits and
+ * the accumulator make_filter() chose, the type is the input type.
+ * The MultiWindowFilter rows list the window sizes, taps is the longest.
+ * The Pipeline rows are the time from the first push() to the last result
+ * popped, with the wait of the filter thread after the slash.
+ *
+ * bench_fir              table on stdout
+ * bench_fir --csv        CSV, one line per measurement
+ * bench_fir --json       JSON array, one object per measurement
+ */
+
+using namespace Tools;
+using namespace exmath;
+
+namespace {
+
+struct Result
+{
+	std::string filter;
+	std::string type;
+	unsigned    taps;
+	std::string api;
+	std::string isa;
+	double      ns_per_sample;
+	double      samples_per_second;
+};
+
+struct Config
+{
+	std::vector<Filter::simd::ISA> isas;
+	std::size_t samples = 1 << 16;
+	std::chrono::nanoseconds min_time = std::chrono::milliseconds(50);
+};
+
+template<class T> const char * type_name();
+template<> const char * type_name<int16_t>() { return "int16"; }
+template<> const char * type_name<int32_t>() { return "int32"; }
+template<> const char * type_name<int64_t>() { return "int64"; }
+template<> const char * type_name<float>()   { return "float"; }
+template<> const char * type_name<double>()  { return "double"; }
+
+// volatile, so the compiler can't drop the filter calls
+template<class T> volatile T sink;
+
+/**
+ * 12 bit adc like input: a sine with some noise on it
+ */
+template<class T>
+static std::vector<T> make_input( std::size_t count )
+{
+	std::vector<T> input( count );
+	uint32_t state = 12345;
+
+	for( std::size_t i = 0; i < count; ++i ) {
+		state = state * 1664525u + 1013904223u;
+		const double noise = double( state >> 24 ) / 256.0 - 0.5;
+		input[i] = static_cast<T>( 2048.0 + 1800.0 * std::sin( double(i) * 0.01 ) + 64.0 * noise );
+	}
+
+	return input;
+}
+
+/**
+ * Runs func() until min_time elapsed, at least 3 times.
+ * Returns the fastest run in ns per sample.
+ */
+template<class Func>
+static double measure( const Config & config, std::size_t samples, Func func )
+{
+	using clock = std::chrono::steady_clock;
+
+	// warm up caches and the branch predictor
+	func();
+
+	double best = HUGE_VAL;
+	unsigned runs = 0;
+	const auto start = clock::now();
+
+	while( runs < 3 || clock::now() - start < config.min_time ) {
+		const auto t0 = clock::now();
+		func();
+		const auto t1 = clock::now();
+
+		const double ns = std::chrono::duration<double,std::nano>( t1 - t0 ).count() / double(samples);
+		best = std::min( best, ns );
+		++runs;
+	}
+
+	return best;
+}
+
+static void add_result( std::vector<Result> & results,
+						const std::string & filter,
+						const std::string & type,
+						unsigned taps,
+						const std::string & api,
+						Filter::simd::ISA isa,
+						double ns )
+{
+	results.push_back( Result{ filter, type, taps, api, Filter::simd::isa_name( isa ), ns, 1e9 / ns } );
+}
+
+/**
+ * The rows of one engine for every ISA: "single" feeds the samples one by
+ * one to operator() or filter(), "block" passes all of them to process()
+ * or filter(). Only the APIs ENGINE has get a row, every row gets a new
+ * engine constructed from args.
+ */
+template<class T, class ENGINE, class... Args>
+static void bench_rows( const Config & config, std::vector<Result> & results,
+						const std::string & name, unsigned taps, const Args & ... args )
+{
+	const std::vector<T> input = make_input<T>( config.samples );
+	std::vector<T> output( input.size() );
+
+	const std::span<const T> in( input );
+	const std::span<T> out( output );
+
+	for( Filter::simd::ISA isa : config.isas ) {
+		Filter::simd::set_isa( isa );
+
+		if constexpr( requires( ENGINE & engine, T x ) { engine( x ); } ) {
+			ENGINE engine( args... );
+
+			const double ns = measure( config, input.size(), [&]() {
+				for( const T & x : input ) {
+					sink<T> = engine( x );
+				}
+			});
+
+			add_result( results, name, type_name<T>(), taps, "single", isa, ns );
+		} else if constexpr( requires( ENGINE & engine, T x ) { engine.filter( x ); } ) {
+			ENGINE engine( args... );
+
+			const double ns = measure( config, input.size(), [&]() {
+				for( const T & x : input ) {
+					sink<T> = engine.filter( x );
+				}
+			});
+
+			add_result( results, name, type_name<T>(), taps, "single", isa, ns );
+		}
+
+		if constexpr( requires( ENGINE & engine ) { engine.process( in, out ); } ) {
+			ENGINE engine( args... );
+
+			const double ns = measure( config, input.size(), [&]() {
+				engine.process( in, out );
+				sink<T> = output.back();
+			});
+
+			add_result( results, name, type_name<T>(), taps, "block", isa, ns );
+		} else if constexpr( requires( ENGINE & engine ) { engine.filter( in, out ); } ) {
+			ENGINE engine( args... );
+
+			const double ns = measure( config, input.size(), [&]() {
+				engine.filter( in, out );
+				sink<T> = output.back();
+			});
+
+			add_result( results, name, type_name<T>(), taps, "block", isa, ns );
+		}
+	}
+}
+
+template<class T, class C, unsigned N>
+static void bench_snrd( const Config & config, std::vector<Result> & results )
+{
+	bench_rows<T, Filter::SNRDFir::Filter<T,C,N>>( config, results, "SNRDFir::Filter", N );
+	bench_rows<T, Filter::SNRDFir::DynamicFilter<T,C>>( config, results, "SNRDFir::DynamicFilter", N, N );
+	bench_rows<T, Filter::SNRDFir::FilterView<T,C,N>>( config, results, "SNRDFir::FilterView", N );
+}
+
+template<class T, class C, unsigned N>
+static void bench_fir( const Config & config, std::vector<Result> & results )
+{
+	bench_rows<T, FIRFilter<T,C,N>>( config, results, "FIRFilter", N, Filter::SNRDFir::Filter<T,C,N>::get_coefficients() );
+}
+
+/**
+ * The rows for a delay line policy other than the default mirrored one.
+ * The policy matters for the single rows, the block API copies the delay
+ * line only once per call.
+ */
+template<class T, class C, unsigned N, template<class,unsigned> class DelayLine>
+static void bench_delay_line( const Config & config, std::vector<Result> & results, const std::string & policy )
+{
+	typedef Filter::SNRDFir::Filter<T,C,N,Filter::SNRDFir::internal::SharedCoefficients<C,N>,DelayLine<T,N>> snrd_type;
+
+	bench_rows<T, snrd_type>( config, results, "SNRDFir::Filter/" + policy, N );
+	bench_rows<T, FIRFilter<T,C,N,DelayLine<T,N>>>( config, results, "FIRFilter/" + policy, N, snrd_type::get_coefficients() );
+}
+
+/**
+ * the narrowest types make_filter() picks for 12 bit ADC values
+ */
+template<unsigned N, unsigned max_input_bits>
+static void bench_make_filter( const Config & config, std::vector<Result> & results )
+{
+	typedef Filter::SNRDFir::NarrowestTypes<N, max_input_bits> types;
+	typedef decltype( Filter::SNRDFir::make_filter<N, max_input_bits>() ) filter_type;
+
+	const std::string name = "SNRDFir::make_filter/" + std::to_string( max_input_bits )
+						   + "/" + type_name<typename types::accumulator_type>();
+
+	bench_rows<typename types::input_type, filter_type>( config, results, name, N );
+}
+
+/**
+ * MultiOrderFilter for bench_rows(), all three outputs are computed,
+ * the second derivative is the result
+ */
+template<class T, class C, unsigned N>
+class MultiOrderRows
+{
+	Filter::SNRDFir::MultiOrderFilter<T,C,N> filter;
+	std::vector<T> smoothed;
+	std::vector<T> first_derivative;
+
+public:
+	T operator()( T x )
+	{
+		const auto r = filter( x );
+		sink<T> = r.smoothed;
+		sink<T> = r.first_derivative;
+
+		return r.second_derivative;
+	}
+
+	void process( std::span<const T> in, std::span<T> out )
+	{
+		// allocates in the warm up run only
+		smoothed.resize( in.size() );
+		first_derivative.resize( in.size() );
+
+		filter.process( in, smoothed, first_derivative, out );
+	}
+};
+
+/**
+ * smoothed value, first and second derivative at once,
+ * three Filter rows of the same type are the reference
+ */
+template<class T, class C, unsigned N>
+static void bench_multi_order( const Config & config, std::vector<Result> & results )
+{
+	bench_rows<T, MultiOrderRows<T,C,N>>( config, results, "SNRDFir::MultiOrderFilter", N );
+}
+
+/**
+ * MultiWindowFilter for bench_rows(), all windows are computed,
+ * the last one is the result
+ */
+template<class T, class C, unsigned... Ns>
+class MultiWindowRows
+{
+	typedef Filter::SNRDFir::MultiWindowFilter<T,C,Ns...> filter_type;
+
+	filter_type filter;
+	std::array<std::vector<T>, filter_type::windows> outputs;
+
+public:
+	T operator()( T x )
+	{
+		const auto r = filter( x );
+
+		for( unsigned w = 0; w + 1 < filter_type::windows; ++w ) {
+			sink<T> = r[w];
+		}
+
+		return r.back();
+	}
+
+	void process( std::span<const T> in, std::span<T> out )
+	{
+		std::array<std::span<T>, filter_type::windows> out_spans;
+
+		// allocates in the warm up run only
+		for( unsigned w = 0; w + 1 < filter_type::windows; ++w ) {
+			outputs[w].resize( in.size() );
+			out_spans[w] = outputs[w];
+		}
+
+		out_spans.back() = out;
+
+		filter.process( in, out_spans );
+	}
+};
+
+/**
+ * all windows at once, one Filter row per window size is the reference
+ */
+template<class T, class C, unsigned... Ns>
+static void bench_multi_window( const Config & config, std::vector<Result> & results )
+{
+	typedef Filter::SNRDFir::MultiWindowFilter<T,C,Ns...> filter_type;
+
+	std::string name = "SNRDFir::MultiWindowFilter/";
+	for( unsigned n : filter_type::window_sizes ) {
+		if( name.back() != '/' ) {
+			name += ",";
+		}
+		name += std::to_string( n );
+	}
+
+	bench_rows<T, MultiWindowRows<T,C,Ns...>>( config, results, name, filter_type::taps );
+}
+
+/**
+ * Pushes all samples, one by one or in blocks of the batch size, and pops
+ * the results whenever some are ready. The output ring holds all results,
+ * so none is dropped.
+ */
+template<class T, class C, unsigned N>
+static void bench_pipeline( const Config & config, std::vector<Result> & results,
+							Filter::SNRDFir::PipelineConfig::Wait wait, const std::string & wait_name )
+{
+	const std::vector<T> input = make_input<T>( config.samples );
+	std::vector<T> output( input.size() );
+
+	Filter::SNRDFir::PipelineConfig pipeline_config;
+	pipeline_config.wait = wait;
+	pipeline_config.output_capacity = input.size();
+
+	for( Filter::simd::ISA isa : config.isas ) {
+		Filter::simd::set_isa( isa );
+
+		for( const std::size_t block_size : { std::size_t( 1 ), pipeline_config.batch_size } ) {
+			Filter::SNRDFir::Pipeline<Filter::SNRDFir::Filter<T,C,N>> pipeline( pipeline_config );
+
+			const double ns = measure( config, input.size(), [&]() {
+				std::size_t popped = 0;
+
+				for( std::size_t pos = 0; pos < input.size(); ) {
+					const std::size_t count = std::min( block_size, input.size() - pos );
+
+					pos += pipeline.push( std::span<const T>( input ).subspan( pos, count ) );
+					popped += pipeline.pop( std::span<T>( output ).subspan( popped ) );
+				}
+
+				pipeline.flush();
+				popped += pipeline.pop( std::span<T>( output ).subspan( popped ) );
+
+				sink<T> = output[popped - 1];
+			});
+
+			add_result( results, "SNRDFir::Pipeline/" + wait_name, type_name<T>(), N,
+						block_size == 1 ? "single" : "block", isa, ns );
+		}
+	}
+}
+
+/**
+ * the low latency differentiator, the centered Filter rows of the same length are the reference
+ */
+template<class T, class C, unsigned N>
+static void bench_one_sided( const Config & config, std::vector<Result> & results )
+{
+	bench_rows<T, Filter::SNRDFir::OneSidedFilter<T,C,N>>( config, results, "SNRDFir::OneSidedFilter", N );
+}
+
+/**
+ * floating point filters with the denominator folded into the taps,
+ * the Filter rows of the same type are the reference
+ */
+template<class T, class C, unsigned N>
+static void bench_normalized( const Config & config, std::vector<Result> & results )
+{
+	bench_rows<T, Filter::SNRDFir::NormalizedFilter<T,C,N>>( config, results, "SNRDFir::NormalizedFilter", N );
+}
+
+/**
+ * long float filters with normalized taps, the Filter rows of double are the reference
+ */
+template<class T, class C, unsigned N>
+static void bench_compensated( const Config & config, std::vector<Result> & results )
+{
+	bench_rows<T, Filter::SNRDFir::CompensatedFilter<T,C,N>>( config, results, "SNRDFir::CompensatedFilter", N );
+	bench_rows<T, Filter::SNRDFir::CompensatedFilter<T,C,N,Filter::SNRDFir::Accumulation::ordered>>( config, results,
+			"SNRDFir::CompensatedFilter/ordered", N );
+}
+
+/**
+ * long filters without the outer taps, for 12 bit ADC values and an error of 1e-9
+ */
+template<class T, class C, unsigned N>
+static void bench_truncated( const Config & config, std::vector<Result> & results )
+{
+	constexpr unsigned M = Filter::SNRDFir::truncated_taps<C,N>( 4096, 1e-9 );
+
+	bench_rows<T, Filter::SNRDFir::TruncatedFilter<T,C,N,M>>( config, results, "SNRDFir::TruncatedFilter/" + std::to_string( M ), N );
+	bench_rows<T, Filter::SNRDFir::DynamicTruncatedFilter<T,C>>( config, results,
+			"SNRDFir::DynamicTruncatedFilter/" + std::to_string( M ), N, N, 4096, 1e-9 );
+}
+
+/**
+ * the FFT engines, BlockFilter switches to the FFT for blocks of --samples from its calibrated crossover on
+ */
+template<class T, class C, unsigned N>
+static void bench_fft( const Config & config, std::vector<Result> & results )
+{
+	bench_rows<T, Filter::SNRDFir::FFTFilter<T,C,N>>( config, results, "SNRDFir::FFTFilter", N );
+
+	// the crossover depends on the kernels of the ISA
+	for( Filter::simd::ISA isa : config.isas ) {
+		Config isa_config = config;
+		isa_config.isas = { isa };
+
+		Filter::simd::set_isa( isa );
+
+		const std::size_t fft_min_block_size = Filter::SNRDFir::BlockFilter<T,C,N>().calibrate();
+		const std::size_t dynamic_fft_min_block_size = Filter::SNRDFir::DynamicBlockFilter<T,C>( N ).calibrate();
+
+		bench_rows<T, Filter::SNRDFir::BlockFilter<T,C,N>>( isa_config, results,
+				"SNRDFir::BlockFilter/" + std::to_string( fft_min_block_size ), N, fft_min_block_size );
+		bench_rows<T, Filter::SNRDFir::DynamicBlockFilter<T,C>>( isa_config, results,
+				"SNRDFir::DynamicBlockFilter/" + std::to_string( dynamic_fft_min_block_size ), N, N, dynamic_fft_min_block_size );
+	}
+}
+
+/**
+ * the multiplier free integer engine, the Filter rows of the same type are the reference
+ */
+template<class T, class C, unsigned N>
+static void bench_cascade( const Config & config, std::vector<Result> & results )
+{
+	bench_rows<T, Filter::SNRDFir::CascadeFilter<T,C,N>>( config, results, "SNRDFir::CascadeFilter", N );
+}
+
+/**
+ * interleaved frames of Channels samples, timed per sample
+ */
+template<class T, class C, unsigned N, unsigned Channels>
+static void bench_filter_bank( const Config & config, std::vector<Result> & results )
+{
+	// whole frames only
+	Config bank_config = config;
+	bank_config.samples = std::max<std::size_t>( 1, config.samples / Channels ) * Channels;
+
+	bench_rows<T, Filter::SNRDFir::FilterBank<T,C,N,Channels>>( bank_config, results,
+			"SNRDFir::FilterBank/" + std::to_string( Channels ), N );
+}
+
+template<class T, class C, unsigned... Ns>
+static void bench_type( const Config & config, std::vector<Result> & results )
+{
+	( bench_snrd<T,C,Ns>( config, results ), ... );
+	( bench_fir<T,C,Ns>( config, results ), ... );
+	( bench_delay_line<T,C,Ns,Filter::MaskedDelayLine>( config, results, "masked" ), ... );
+	( bench_delay_line<T,C,Ns,Filter::ShiftDelayLine>( config, results, "shift" ), ... );
+}
+
+static std::string format_double( double value, int precision )
+{
+	std::ostringstream str;
+	str << std::fixed << std::setprecision( precision ) << value;
+	return str.str();
+}
+
+static void print_table( const std::vector<Result> & results )
+{
+	ColBuilder cb;
+
+	const int col_filter = cb.addCol( "Filter" );
+	const int col_type   = cb.addCol( "Type" );
+	const int col_taps   = cb.addCol( "Taps" );
+	const int col_api    = cb.addCol( "API" );
+	const int col_isa    = cb.addCol( "Kernel" );
+	const int col_ns     = cb.addCol( "ns/sample" );
+	const int col_sps    = cb.addCol( "MSamples/s" );
+
+	for( const Result & r : results ) {
+		cb.addColData( col_filter, r.filter );
+		cb.addColData( col_type,   r.type );
+		cb.addColData( col_taps,   std::to_string( r.taps ) );
+		cb.addColData( col_api,    r.api );
+		cb.addColData( col_isa,    r.isa );
+		cb.addColData( col_ns,     format_double( r.ns_per_sample, 2 ) );
+		cb.addColData( col_sps,    format_double( r.samples_per_second / 1e6, 2 ) );
+	}
+
+	std::cout << cb.toString() << std::endl;
+}
+
+static void print_csv( const std::vector<Result> & results )
+{
+	std::cout << "filter,type,taps,api,kernel,ns_per_sample,samples_per_second\n";
+
+	for( const Result & r : results ) {
+		std::cout << r.filter << ','
+				  << r.type << ','
+				  << r.taps << ','
+				  << r.api << ','
+				  << r.isa << ','
+				  << format_double( r.ns_per_sample, 3 ) << ','
+				  << format_double( r.samples_per_second, 0 ) << '\n';
+	}
+}
+
+static void print_json( const std::vector<Result> & results )
+{
+	std::cout << "[\n";
+
+	for( std::size_t i = 0; i < results.size(); ++i ) {
+		const Result & r = results[i];
+
+		std::cout << "  { \"filter\": \"" << r.filter << "\""
+				  << ", \"type\": \"" << r.type << "\""
+				  << ", \"taps\": " << r.taps
+				  << ", \"api\": \"" << r.api << "\""
+				  << ", \"kernel\": \"" << r.isa << "\""
+				  << ", \"ns_per_sample\": " << format_double( r.ns_per_sample, 3 )
+				  << ", \"samples_per_second\": " << format_double( r.samples_per_second, 0 )
+				  << " }" << ( i + 1 < results.size() ? "," : "" ) << '\n';
+	}
+
+	std::cout << "]" << std::endl;
+}
+
+} // namespace
+
+int main( int argc, char **argv )
+{
+	try {
+		ColoredOutput co;
+
+		Arg::Arg arg( argc, argv );
+		arg.addPrefix( "-" );
+		arg.addPrefix( "--" );
+
+		Arg::OptionChain oc_info;
+		arg.addChainR(&oc_info);
+		oc_info.setMinMatch(1);
+		oc_info.setContinueOnMatch( false );
+		oc_info.setContinueOnFail( true );
+
+		Arg::FlagOption o_help( "help" );
+		o_help.setDescription( "Show this page" );
+		oc_info.addOptionR( &o_help );
+
+		Arg::FlagOption o_debug("d");
+		o_debug.addName( "debug" );
+		o_debug.setDescription("print debugging messages");
+		o_debug.setRequired(false);
+		arg.addOptionR( &o_debug );
+
+		Arg::FlagOption o_csv("csv");
+		o_csv.setDescription("print the results as CSV");
+		o_csv.setRequired(false);
+		arg.addOptionR( &o_csv );
+
+		Arg::FlagOption o_json("json");
+		o_json.setDescription("print the results as JSON");
+		o_json.setRequired(false);
+		arg.addOptionR( &o_json );
+
+		Arg::StringOption o_kernel("kernel");
+		o_kernel.setDescription("only benchmark this kernel: scalar, sse4.2, avx2 or avx512");
+		o_kernel.setRequired(false);
+		arg.addOptionR( &o_kernel );
+
+		Arg::IntOption o_samples("samples");
+		o_samples.setDescription("number of samples per run, default 65536");
+		o_samples.setRequired(false);
+		arg.addOptionR( &o_samples );
+
+		Arg::IntOption o_min_time("min-time");
+		o_min_time.setDescription("minimum time per measurement in ms, default 50");
+		o_min_time.setRequired(false);
+		arg.addOptionR( &o_min_time );
+
+		if( !arg.parse() )
+		{
+			std::cout << arg.getHelp(5,20,30, 80 ) << std::endl;
+			return 1;
+		}
+
+		if( o_debug.getState() )
+		{
+			Tools::x_debug = new OutDebug();
+		}
+
+		if( o_help.getState() ) {
+			std::cout << arg.getHelp(5,20,30, 80 ) << std::endl;
+			return 1;
+		}
+
+		Config config;
+
+		if( o_samples.isSet() ) {
+			if( o_samples.getValues()->at(0) <= 0 ) {
+				throw STDERR_EXCEPTION( "--samples has to be greater than 0" );
+			}
+			config.samples = o_samples.getValues()->at(0);
+		}
+
+		if( o_min_time.isSet() ) {
+			config.min_time = std::chrono::milliseconds( o_min_time.getValues()->at(0) );
+		}
+
+		for( unsigned i = 0; i <= static_cast<unsigned>(Filter::simd::detect_isa()); ++i ) {
+			const Filter::simd::ISA isa = static_cast<Filter::simd::ISA>(i);
+
+			if( !o_kernel.isSet() || o_kernel.getValues()->at(0) == Filter::simd::isa_name( isa ) ) {
+				config.isas.push_back( isa );
+			}
+		}
+
+		if( config.isas.empty() ) {
+			throw STDERR_EXCEPTION( Tools::format( "kernel %s is unknown or not supported by this CPU",
+												   o_kernel.getValues()->at(0) ) );
+		}
+
+		std::vector<Result> results;
+
+		// the coefficients overflow the type beyond these sizes
+		bench_type<int32_t,int32_t,5,11,27>( config, results );
+		bench_type<int64_t,int64_t,5,11,27,55>( config, results );
+		bench_type<float,float,5,11,27,55,127>( config, results );
+		bench_type<double,double,5,11,27,55,127,255,795>( config, results );
+
+		bench_make_filter<11,12>( config, results );
+		bench_make_filter<27,12>( config, results );
+
+		bench_multi_order<int64_t,int64_t,27>( config, results );
+		bench_multi_order<float,float,127>( config, results );
+		bench_multi_order<double,double,127>( config, results );
+
+		bench_multi_window<int32_t,int32_t,5,11,21>( config, results );
+		bench_multi_window<float,float,11,27,55,127>( config, results );
+		bench_multi_window<double,double,11,27,55,127>( config, results );
+
+		bench_pipeline<int64_t,int64_t,55>( config, results, Filter::SNRDFir::PipelineConfig::Wait::futex, "futex" );
+		bench_pipeline<int64_t,int64_t,55>( config, results, Filter::SNRDFir::PipelineConfig::Wait::busy_poll, "busy_poll" );
+		bench_pipeline<float,float,127>( config, results, Filter::SNRDFir::PipelineConfig::Wait::futex, "futex" );
+
+		bench_one_sided<int32_t,int32_t,11>( config, results );
+		bench_one_sided<int64_t,int64_t,27>( config, results );
+		bench_one_sided<float,float,55>( config, results );
+		bench_one_sided<double,double,55>( config, results );
+
+		bench_normalized<float,float,27>( config, results );
+		bench_normalized<float,float,127>( config, results );
+		bench_normalized<double,double,27>( config, results );
+		bench_normalized<double,double,127>( config, results );
+
+		bench_compensated<float,float,127>( config, results );
+		bench_compensated<float,float,255>( config, results );
+		bench_compensated<float,float,795>( config, results );
+
+		bench_truncated<double,double,255>( config, results );
+		bench_truncated<double,double,795>( config, results );
+
+		bench_cascade<int32_t,int32_t,11>( config, results );
+		bench_cascade<int32_t,int32_t,27>( config, results );
+		bench_cascade<int64_t,int64_t,27>( config, results );
+		bench_cascade<int64_t,int64_t,55>( config, results );
+
+		bench_filter_bank<int32_t,int32_t,11,64>( config, results );
+		bench_filter_bank<float,float,55,8>( config, results );
+		bench_filter_bank<double,double,27,4>( config, results );
+
+		bench_fft<float,float,127>( config, results );
+		bench_fft<double,double,255>( config, results );
+		bench_fft<double,double,795>( config, results );
+
+		Filter::simd::set_isa( Filter::simd::detect_isa() );
+
+		if( o_json.getState() ) {
+			print_json( results );
+		} else if( o_csv.getState() ) {
+			print_csv( results );
+		} else {
+			print_table( results );
+		}
+
+	} catch( const std::exception & error ) {
+		std::cerr << "Error: " << error.what() << std::endl;
+		return 1;
+	} catch( ... ) {
+		std::cerr << "Unknown Error\n";
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,1381 @@
+/*
+ * CheckEngines.cc
+ */
+
+#include "CheckEngines.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "SNRDFir.hpp"
+#include "SNRDCascade.hpp"
+#include "SNRDFilterBank.hpp"
+#include "SNRDDynamic.hpp"
+#include "SNRDParallel.hpp"
+#include "SNRDMultiOrder.hpp"
+#include "SNRDMultiWindow.hpp"
+#include "SNRDPipeline.hpp"
+#include "SNRDOneSided.hpp"
+#include "SNRDView.hpp"
+#include "SNRDCompensated.hpp"
+#include "SNRDTruncated.hpp"
+#include "SNRDNormalized.hpp"
+#include "SNRDFactory.hpp"
+#include "FFTConvolution.hpp"
+#include "FirFilter.hpp"
+
+using namespace exmath::Filter::SNRDFir;
+
+namespace {
+
+	constexpr std::size_t SAMPLES = 5000;
+
+	// the block sizes of process(), one after the other, so the engines see
+	// single samples, blocks around their internal block size and long ones
+	constexpr std::size_t BLOCK_SIZES[] = { 1, 7, 255, 256, 257, 1000, 3 };
+
+	/**
+	 * a sine with some deterministic noise, up to |amplitude|
+	 */
+	template<typename T>
+	std::vector<T> make_input( double amplitude, std::size_t count = SAMPLES )
+	{
+		std::vector<T> in( count );
+
+		for( std::size_t i = 0; i < in.size(); ++i ) {
+			const double noise = double( ( i * 7919 ) % 97 ) / 96.0 - 0.5;
+			in[i] = static_cast<T>( amplitude * ( 0.9 * std::sin( i * 0.013 ) + 0.1 * noise ) );
+		}
+
+		return in;
+	}
+
+	/**
+	 * filter( in[k] ) for every sample, on a copy of filter
+	 */
+	template<class FILTER, typename T>
+	std::vector<T> run_single( FILTER filter, const std::vector<T> & in )
+	{
+		std::vector<T> out( in.size() );
+
+		for( std::size_t i = 0; i < in.size(); ++i ) {
+			out[i] = filter( in[i] );
+		}
+
+		return out;
+	}
+
+	/**
+	 * filter.process() with all block_sizes in turn, counted in frames of frame_size samples
+	 */
+	template<class FILTER, typename T>
+	std::vector<T> run_blocks( FILTER & filter, const std::vector<T> & in, std::size_t frame_size = 1,
+							   std::span<const std::size_t> block_sizes = BLOCK_SIZES )
+	{
+		std::vector<T> out( in.size() );
+
+		for( std::size_t pos = 0, block = 0; pos < in.size(); ++block ) {
+			const std::size_t count = std::min( block_sizes[block % block_sizes.size()] * frame_size, in.size() - pos );
+
+			filter.process( std::span<const T>( in ).subspan( pos, count ), std::span<T>( out ).subspan( pos, count ) );
+			pos += count;
+		}
+
+		return out;
+	}
+
+	/**
+	 * filter.process() with all samples in one block
+	 */
+	template<class FILTER, typename T>
+	std::vector<T> run_whole( FILTER & filter, const std::vector<T> & in )
+	{
+		std::vector<T> out( in.size() );
+
+		filter.process( in, out );
+
+		return out;
+	}
+
+	/**
+	 * the reference, Filter<T,C,N> sample by sample
+	 */
+	template<typename T, typename C, unsigned N>
+	std::vector<T> run_reference( const std::vector<T> & in )
+	{
+		return run_single( Filter<T,C,N>(), in );
+	}
+
+	/**
+	 * Prints one line for the check. actual[i] may differ from expected[i]
+	 * by tolerances[i], a tolerance of 0 means bit identical.
+	 */
+	template<typename T>
+	bool compare( std::ostream & out, const std::string & name,
+				  const std::vector<T> & expected, const std::vector<T> & actual,
+				  const std::vector<double> & tolerances )
+	{
+		std::size_t mismatches = 0;
+		double max_error = 0;
+
+		for( std::size_t i = 0; i < expected.size(); ++i ) {
+			const double error = std::abs( double( expected[i] ) - double( actual[i] ) );
+
+			const bool mismatch = tolerances[i] == 0
+					? std::memcmp( &expected[i], &actual[i], sizeof(T) ) != 0
+					: !( error <= tolerances[i] );
+
+			if( mismatch ) {
+				++mismatches;
+				max_error = std::max( max_error, error );
+			}
+		}
+
+		out << name << ": ";
+
+		if( mismatches == 0 ) {
+			out << "OK";
+		} else {
+			out << "FAILED, " << mismatches << " of " << expected.size()
+				<< " results differ by up to " << max_error;
+		}
+
+		out << std::endl;
+
+		return mismatches == 0;
+	}
+
+	/**
+	 * the same tolerance for all results, without one they have to be bit identical
+	 */
+	template<typename T>
+	bool compare( std::ostream & out, const std::string & name,
+				  const std::vector<T> & expected, const std::vector<T> & actual,
+				  double tolerance = 0 )
+	{
+		return compare( out, name, expected, actual, std::vector<double>( expected.size(), tolerance ) );
+	}
+
+	/**
+	 * What every engine is checked for: filter( in[k] ) sample by sample,
+	 * if it has it, process() with all BLOCK_SIZES in turn and process()
+	 * with all samples in one block. Each run gets a fresh engine from
+	 * make_engine(), so engines which can't be copied work as well.
+	 * The tolerance is one for all results or one per result, like with compare().
+	 */
+	template<class MAKE_ENGINE, typename T, typename TOLERANCE = double>
+	bool check_engine( std::ostream & out, const std::string & name, MAKE_ENGINE make_engine,
+					   const std::vector<T> & in, const std::vector<T> & expected,
+					   const TOLERANCE & tolerance = 0, std::size_t frame_size = 1 )
+	{
+		typedef std::invoke_result_t<MAKE_ENGINE &> ENGINE;
+
+		bool ok = true;
+
+		if constexpr( requires( ENGINE & engine, T sample ) { engine( sample ); } ) {
+			ok = compare( out, name + " single", expected, run_single( make_engine(), in ), tolerance );
+		}
+
+		ENGINE blocks = make_engine();
+		ENGINE whole = make_engine();
+
+		ok = compare( out, name + " process", expected, run_blocks( blocks, in, frame_size ), tolerance ) && ok;
+		ok = compare( out, name + " one block", expected, run_whole( whole, in ), tolerance ) && ok;
+
+		return ok;
+	}
+
+	/**
+	 * process() has to return exactly what add() and get_result() return
+	 * sample by sample, in blocks of single samples, blocks shorter than N
+	 * and blocks longer than the window of process(). None of them divides
+	 * SAMPLES, so the last block is a partial one.
+	 */
+	template<typename T, typename C, unsigned N>
+	bool check_process( std::ostream & out, const std::string & name, double amplitude )
+	{
+		typedef Filter<T,C,N> FILTER;
+
+		const std::vector<T> in = make_input<T>( amplitude );
+		std::vector<T> expected( in.size() );
+
+		FILTER reference;
+
+		for( std::size_t i = 0; i < in.size(); ++i ) {
+			reference.add( in[i] );
+			expected[i] = reference.get_result();
+		}
+
+		bool ok = true;
+
+		for( const std::size_t block_size : { std::size_t( 1 ), std::size_t( N/2 ), std::size_t( N + FILTER::block_window_size + 1 ) } ) {
+			FILTER filter;
+
+			ok = compare( out, name + " process, blocks of " + std::to_string( block_size ), expected,
+						  run_blocks( filter, in, 1, std::span<const std::size_t>( &block_size, 1 ) ) ) && ok;
+		}
+
+		return ok;
+	}
+
+	/**
+	 * The folded sum c[i] * ( x[N-1-i] - x[i] ) against the direct form with
+	 * all N taps of get_coefficients(), N-1 zeros in front of the input.
+	 * Integer sums have to be bit exact, floating point ones may differ by
+	 * the rounding errors of both sums.
+	 */
+	template<typename T, typename C, unsigned N>
+	bool check_folded( std::ostream & out, const std::string & name, double amplitude )
+	{
+		constexpr std::array<C, N> taps = Filter<T,C,N>::get_coefficients();
+
+		const std::vector<T> in = make_input<T>( amplitude );
+
+		std::vector<T> padded( N - 1 + in.size(), T(0) );
+		std::copy( in.begin(), in.end(), padded.begin() + ( N - 1 ) );
+
+		std::vector<C> expected( in.size() );
+		std::vector<C> sums( in.size() );
+		std::vector<double> tolerances( in.size() );
+
+		Filter<T,C,N> filter;
+
+		for( std::size_t k = 0; k < in.size(); ++k ) {
+			const T * x = &padded[k];
+			C sum = 0;
+			double abs_sum = 0;
+
+			for( unsigned i = 0; i < N; ++i ) {
+				sum += taps[i] * C( x[i] );
+				abs_sum += std::abs( double( taps[i] ) * double( x[i] ) );
+			}
+
+			expected[k] = sum;
+
+			if constexpr( std::is_floating_point_v<C> ) {
+				tolerances[k] = N * std::numeric_limits<C>::epsilon() * abs_sum;
+			}
+
+			filter.add( in[k] );
+			sums[k] = filter.calculate();
+		}
+
+		return compare( out, name + " folded against unfolded", expected, sums, tolerances );
+	}
+
+	/**
+	 * FIRFilter with the engine interface, filter( in[k] ) and the block filter()
+	 */
+	template<typename T, typename C, int N, class DelayLine>
+	class FIRFilterEngine
+	{
+		FIRFilter<T,C,N,DelayLine> filter;
+
+	public:
+		explicit FIRFilterEngine( const std::array<C, N> & taps )
+		: filter( taps )
+		{
+		}
+
+		T operator()( T input ) {
+			return filter.filter( input );
+		}
+
+		void process( std::span<const T> in, std::span<T> out ) {
+			filter.filter( in, out );
+		}
+	};
+
+	/**
+	 * taps[0] applies to the newest input, the other taps to the inputs
+	 * before it, oldest first. Summed oldest input first and newest last,
+	 * without fused multiply adds, like FIRFilter does on every instruction set.
+	 */
+	template<typename T, typename C, int N>
+	EXMATH_NO_FP_CONTRACT
+	std::vector<T> run_fir_reference( const std::array<C, N> & taps, const std::vector<T> & in )
+	{
+		std::vector<T> out( in.size() );
+
+		for( std::size_t k = 0; k < in.size(); ++k ) {
+			C sum = 0;
+
+			for( int i = 1; i < N; ++i ) {
+				if( k + i >= std::size_t( N ) ) {
+					sum += taps[i] * C( in[k + i - N] );
+				}
+			}
+
+			sum += taps[0] * C( in[k] );
+			out[k] = static_cast<T>( sum );
+		}
+
+		return out;
+	}
+
+	template<typename T, typename C, int N, class DelayLine = exmath::Filter::MirroredDelayLine<T,N>>
+	bool check_fir_filter( std::ostream & out, const std::string & name, double amplitude )
+	{
+		std::array<C, N> taps;
+
+		for( int i = 0; i < N; ++i ) {
+			taps[i] = static_cast<C>( ( i * 37 ) % 11 - 5 ) / ( std::is_floating_point_v<C> ? C(7) : C(1) );
+		}
+
+		const std::vector<T> in = make_input<T>( amplitude );
+		const std::vector<T> expected = run_fir_reference<T,C,N>( taps, in );
+
+		return check_engine( out, name, [&]() { return FIRFilterEngine<T,C,N,DelayLine>( taps ); }, in, expected );
+	}
+
+	/**
+	 * process_decimated() has to return every factor-th result of operator(),
+	 * for blocks which mostly aren't multiples of factor, so the phase has to
+	 * carry over from one call to the next. operator() has to go on from
+	 * the state it leaves, whatever the phase is at the end.
+	 */
+	template<typename T, typename C, unsigned N>
+	bool check_decimated( std::ostream & out, const std::string & name, double amplitude, unsigned factor )
+	{
+		const std::vector<T> in = make_input<T>( amplitude );
+		const std::vector<T> reference = run_reference<T,C,N>( in );
+
+		// the decimated part ends in the middle of a decimation period
+		const std::size_t decimated_size = in.size() / 2 / factor * factor + factor / 2;
+
+		std::vector<T> expected;
+		std::vector<T> results( decimated_size / factor );
+		std::size_t written = 0;
+
+		for( std::size_t i = factor - 1; i < decimated_size; i += factor ) {
+			expected.push_back( reference[i] );
+		}
+
+		Filter<T,C,N> filter;
+
+		for( std::size_t pos = 0, block = 0; pos < decimated_size; ++block ) {
+			const std::size_t count = std::min( BLOCK_SIZES[block % std::size( BLOCK_SIZES )], decimated_size - pos );
+
+			written += filter.process_decimated( std::span<const T>( in ).subspan( pos, count ),
+												 std::span<T>( results ).subspan( written ), factor );
+			pos += count;
+		}
+
+		if( written != expected.size() ) {
+			out << name << " decimated by " << factor << ": FAILED, "
+				<< written << " of " << expected.size() << " results" << std::endl;
+			return false;
+		}
+
+		std::vector<T> continued( in.size() - decimated_size );
+
+		for( std::size_t i = 0; i < continued.size(); ++i ) {
+			continued[i] = filter( in[decimated_size + i] );
+		}
+
+		const std::string decimated_name = name + " decimated by " + std::to_string( factor );
+
+		bool ok = compare( out, decimated_name, expected, results );
+		ok = compare( out, decimated_name + ", continued with operator()",
+					  std::vector<T>( reference.begin() + decimated_size, reference.end() ), continued ) && ok;
+
+		return ok;
+	}
+
+	/**
+	 * Filter whose delay line can be changed without dirtying the sum,
+	 * so a cached result can be told from a calculated one
+	 */
+	template<typename T, typename C, unsigned N>
+	class CacheProbe : public Filter<T,C,N>
+	{
+	public:
+		void push_unnoticed( T input ) {
+			this->delay_line.push( input );
+		}
+	};
+
+	/**
+	 * get_result() after operator() has to return the cached sum without
+	 * calculating it again, the next add() has to make it calculate.
+	 */
+	template<typename T, typename C, unsigned N>
+	bool check_cache( std::ostream & out, const std::string & name, double amplitude )
+	{
+		const std::vector<T> in = make_input<T>( amplitude, 2 * N );
+
+		CacheProbe<T,C,N> probe;
+		Filter<T,C,N> reference;
+
+		T result = 0;
+
+		for( std::size_t i = 0; i + 1 < in.size(); ++i ) {
+			result = probe( in[i] );
+			reference.add( in[i] );
+		}
+
+		// a sample the sum doesn't know about, only a calculation sees it
+		probe.push_unnoticed( T( amplitude ) );
+		reference.add( T( amplitude ) );
+
+		const T cached = probe.get_result();
+		const T last = probe.get_last_result();
+
+		probe.add( in.back() );
+		reference.add( in.back() );
+
+		const T calculated = probe.get_result();
+		const T expected = reference.get_result();
+
+		const bool ok = cached == result && last == result && calculated == expected;
+
+		out << name << " cache: ";
+
+		if( ok ) {
+			out << "OK";
+		} else {
+			out << "FAILED, cached " << double( cached ) << " and " << double( last ) << " instead of " << double( result )
+				<< ", calculated " << double( calculated ) << " instead of " << double( expected );
+		}
+
+		out << std::endl;
+
+		return ok;
+	}
+
+	/**
+	 * The shift of the integer Normalizer has to round towards zero, so it
+	 * has to return exactly sum / denominator, negative sums included.
+	 * Every power of two is checked, and two denominators which fall
+	 * back to the division.
+	 */
+	template<typename C>
+	bool check_normalizer( std::ostream & out, const std::string & name )
+	{
+		constexpr C min = std::numeric_limits<C>::min();
+		constexpr C max = std::numeric_limits<C>::max();
+
+		std::vector<C> denominators = { 3, 1000 };
+
+		for( int shift = 0; shift < std::numeric_limits<C>::digits; ++shift ) {
+			denominators.push_back( C(1) << shift );
+		}
+
+		std::vector<C> expected;
+		std::vector<C> results;
+
+		for( const C denominator : denominators ) {
+			const internal::Normalizer<C> normalizer( denominator );
+
+			std::vector<C> sums = { 0, 1, -1, min, min + 1, max, max - 1 };
+
+			for( const C d : { denominator - 1, denominator, denominator + 1, denominator + denominator / 2 } ) {
+				sums.push_back( d );
+				sums.push_back( -d );
+			}
+
+			for( uint64_t i = 1; i < 1000; ++i ) {
+				const C sum = static_cast<C>( i * 0x9E3779B97F4A7C15ull );
+
+				sums.push_back( sum );
+				sums.push_back( sum / denominator );
+			}
+
+			for( const C sum : sums ) {
+				expected.push_back( sum / denominator );
+				results.push_back( normalizer( sum ) );
+			}
+		}
+
+		return compare( out, name + " against the division", expected, results );
+	}
+
+	/**
+	 * NormalizedFilter has to stay within 1 ulp of the sum of Filter
+	 * / denominator * scale, for the default and an adjusted denominator.
+	 * With a power of two scale and the default denominator nothing is
+	 * rounded at all, the results have to be identical then.
+	 */
+	template<typename T, typename C, unsigned N>
+	bool check_normalized( std::ostream & out, const std::string & name, double amplitude )
+	{
+		const std::vector<T> in = make_input<T>( amplitude );
+
+		bool ok = true;
+
+		for( const C dd : { Filter<T,C,N>::calc_default_denominator(), C(1000) } ) {
+			std::vector<C> sums( in.size() );
+
+			Filter<T,C,N> filter;
+
+			for( std::size_t i = 0; i < in.size(); ++i ) {
+				filter.add( in[i] );
+				sums[i] = filter.calculate();
+			}
+
+			for( const C scale : { C(1), C(256), C(48000 * 3.3 / 4096) } ) {
+				std::vector<T> expected( in.size() );
+				std::vector<double> tolerances( in.size() );
+
+				const bool exact = dd == Filter<T,C,N>::calc_default_denominator() && scale != C(48000 * 3.3 / 4096);
+
+				for( std::size_t i = 0; i < in.size(); ++i ) {
+					expected[i] = static_cast<T>( static_cast<long double>( sums[i] ) / dd * scale );
+
+					if( !exact ) {
+						tolerances[i] = std::nextafter( std::abs( expected[i] ), std::numeric_limits<T>::infinity() ) - std::abs( expected[i] );
+					}
+				}
+
+				std::ostringstream scaled_name;
+				scaled_name << name << " denominator " << dd << ", scale " << scale;
+
+				ok = check_engine( out, scaled_name.str(), [=]() {
+					NormalizedFilter<T,C,N> normalized( scale );
+					normalized.set_default_denominator( dd );
+					return normalized;
+				}, in, expected, tolerances ) && ok;
+			}
+		}
+
+		return ok;
+	}
+
+	/**
+	 * make_filter() has to return the hand written Filter<T,C,N>, and the
+	 * narrow types have to hold the worst case: inputs of the full range
+	 * with the signs of the taps, then with the opposite signs. The results
+	 * have to be the ones of Filter<int64_t,int64_t,N>.
+	 */
+	template<unsigned N, unsigned bits, typename T, typename C>
+	bool check_make_filter( std::ostream & out )
+	{
+		static_assert( std::is_same_v<decltype( make_filter<N,bits>() ), Filter<T,C,N>>, "make_filter() chose other types." );
+
+		constexpr int64_t max_input = ( int64_t(1) << bits ) - 1;
+		constexpr std::array<int64_t, N> taps = Filter<int64_t,int64_t,N>::get_coefficients();
+
+		std::vector<T> in = make_input<T>( max_input );
+
+		for( const int64_t sign : { 1, -1 } ) {
+			for( const int64_t tap : taps ) {
+				in.push_back( static_cast<T>( sign * ( ( tap > 0 ) - ( tap < 0 ) ) * max_input ) );
+			}
+		}
+
+		const std::vector<int64_t> wide = run_reference<int64_t,int64_t,N>( std::vector<int64_t>( in.begin(), in.end() ) );
+
+		return check_engine( out, "make_filter<" + std::to_string( N ) + "," + std::to_string( bits ) + ">()",
+							 []() { return make_filter<N,bits>(); }, in, std::vector<T>( wide.begin(), wide.end() ) );
+	}
+
+	/**
+	 * Up to unroll_threshold taps, Filter with the shared coefficients sums
+	 * them fully unrolled, Filter with its own copy of the same taps sums
+	 * them in the loop. Both have to return the same results.
+	 */
+	template<typename T, typename C, unsigned N>
+	bool check_unrolled( std::ostream & out, const std::string & types, double amplitude )
+	{
+		static_assert( N <= Filter<T,C,N>::unroll_threshold, "Only shorter filters are unrolled." );
+
+		typedef Filter<T,C,N,internal::InstanceCoefficients<C,N>> LOOP_FILTER;
+
+		const std::vector<T> in = make_input<T>( amplitude );
+
+		return check_engine( out, "Filter<" + types + "," + std::to_string( N ) + "> unrolled against the loop",
+							 []() { return Filter<T,C,N>(); }, in, run_single( LOOP_FILTER(), in ) );
+	}
+
+	/**
+	 * A delay line has to index the last N samples oldest first, like
+	 * a plain history with N zeros in front, after every push() and after
+	 * assign() at a position the ring doesn't start at.
+	 */
+	template<class DelayLine>
+	bool check_delay_line( std::ostream & out, const std::string & name )
+	{
+		constexpr unsigned N = DelayLine::size;
+
+		std::vector<int32_t> history( N, 0 );
+		std::size_t mismatches = 0;
+
+		DelayLine line;
+
+		auto check = [&]() {
+			std::array<int32_t, N> copy;
+			line.copy_to( copy.data() );
+
+			for( unsigned i = 0; i < N; ++i ) {
+				const int32_t expected = history[history.size() - N + i];
+
+				if( line[i] != expected || copy[i] != expected ) {
+					++mismatches;
+				}
+			}
+		};
+
+		for( int32_t sample = 1; sample <= int32_t( 3 * N + 1 ); ++sample ) {
+			line.push( sample );
+			history.push_back( sample );
+			check();
+		}
+
+		std::array<int32_t, N> assigned;
+
+		for( unsigned i = 0; i < N; ++i ) {
+			assigned[i] = 1000 + i;
+		}
+
+		line.assign( assigned.data() );
+		history.insert( history.end(), assigned.begin(), assigned.end() );
+		check();
+
+		for( int32_t sample = 2000; sample < int32_t( 2000 + 2 * N + 3 ); ++sample ) {
+			line.push( sample );
+			history.push_back( sample );
+			check();
+		}
+
+		out << name << ": ";
+
+		if( mismatches == 0 ) {
+			out << "OK";
+		} else {
+			out << "FAILED, " << mismatches << " samples differ";
+		}
+
+		out << std::endl;
+
+		return mismatches == 0;
+	}
+
+	template<unsigned N>
+	bool check_delay_lines( std::ostream & out )
+	{
+		const std::string size = "<int32_t," + std::to_string( N ) + ">";
+
+		bool ok = check_delay_line<exmath::Filter::MirroredDelayLine<int32_t,N>>( out, "MirroredDelayLine" + size );
+		ok = check_delay_line<exmath::Filter::MaskedDelayLine<int32_t,N>>( out, "MaskedDelayLine" + size ) && ok;
+		ok = check_delay_line<exmath::Filter::ShiftDelayLine<int32_t,N>>( out, "ShiftDelayLine" + size ) && ok;
+
+		return ok;
+	}
+
+	/**
+	 * Filter with the masked and the shift register delay line has to
+	 * return exactly the results of the default mirrored one
+	 */
+	template<typename T, typename C, unsigned N>
+	bool check_delay_line_policies( std::ostream & out, const std::string & types, double amplitude )
+	{
+		typedef internal::SharedCoefficients<C,N> COEFFICIENTS;
+
+		const std::vector<T> in = make_input<T>( amplitude );
+		const std::vector<T> expected = run_reference<T,C,N>( in );
+		const std::string name = "Filter<" + types + "," + std::to_string( N ) + ",";
+
+		bool ok = check_engine( out, name + "MaskedDelayLine>",
+								[]() { return Filter<T,C,N,COEFFICIENTS,exmath::Filter::MaskedDelayLine<T,N>>(); },
+								in, expected );
+		ok = check_engine( out, name + "ShiftDelayLine>",
+						   []() { return Filter<T,C,N,COEFFICIENTS,exmath::Filter::ShiftDelayLine<T,N>>(); },
+						   in, expected ) && ok;
+
+		return ok;
+	}
+
+	template<typename T, typename C, unsigned N>
+	bool check_cascade( std::ostream & out, const std::string & name )
+	{
+		const std::vector<T> in = make_input<T>( 0xFFF );
+
+		return check_engine( out, name, []() { return CascadeFilter<T,C,N>(); }, in, run_reference<T,C,N>( in ) );
+	}
+
+	/**
+	 * The FFT engines round differently, the error is relative to the
+	 * magnitude of the input. BlockFilter is checked with the default and
+	 * the calibrated crossover, with the FFT for every block longer than N,
+	 * which mixes both engines, and without the FFT. ParallelFilter has to
+	 * prime the FFT engine of every chunk and keeps the same tolerance,
+	 * test_fir --threads --fft relies on it.
+	 */
+	template<typename T, typename C, unsigned N>
+	bool check_fft( std::ostream & out, const std::string & name, std::size_t samples )
+	{
+		constexpr double amplitude = 4;
+		constexpr double tolerance = amplitude * 4 * std::numeric_limits<T>::epsilon();
+
+		const std::vector<T> in = make_input<T>( amplitude, samples );
+		const std::vector<T> expected = run_reference<T,C,N>( in );
+
+		bool ok = check_engine( out, "FFTFilter" + name, []() { return FFTFilter<T,C,N>(); }, in, expected, tolerance );
+		ok = check_engine( out, "DynamicFFTFilter" + name, []() { return DynamicFFTFilter<T,C>( N ); }, in, expected, tolerance ) && ok;
+
+		for( std::size_t fft_min_block_size : { BlockFilter<T,C,N>().get_fft_min_block_size(), BlockFilter<T,C,N>().calibrate(),
+												 std::size_t( N + 1 ), std::size_t( 0 ) } ) {
+			const std::string sizes = name + " fft_min_block_size " + std::to_string( fft_min_block_size );
+
+			ok = check_engine( out, "BlockFilter" + sizes,
+							   [=]() { return BlockFilter<T,C,N>( fft_min_block_size ); }, in, expected, tolerance ) && ok;
+			ok = check_engine( out, "DynamicBlockFilter" + sizes,
+							   [=]() { return DynamicBlockFilter<T,C>( N, fft_min_block_size ); }, in, expected, tolerance ) && ok;
+		}
+
+		// chunks longer than N, so they are filtered by the FFT engine
+		ok = check_engine( out, "ParallelFilter<BlockFilter" + name + ">",
+						   []() { return ParallelFilter<BlockFilter<T,C,N>>( 4, 2 * N, BlockFilter<T,C,N>( N + 1 ) ); },
+						   in, expected, tolerance ) && ok;
+		ok = check_engine( out, "ParallelFilter<DynamicBlockFilter" + name + ">",
+						   []() { return ParallelFilter<DynamicBlockFilter<T,C>>( 4, 2 * N, DynamicBlockFilter<T,C>( N, N + 1 ) ); },
+						   in, expected, tolerance ) && ok;
+
+		return ok;
+	}
+
+	/**
+	 * Channel ch gets the input from sample ch * 101 on. Besides the whole
+	 * interleaved block, the frames are passed in blocks of 1, 7, ... frames
+	 * and one by one with add() and calculate().
+	 */
+	template<typename T, typename C, unsigned N, unsigned Channels>
+	bool check_filter_bank( std::ostream & out, const std::string & name )
+	{
+		const std::vector<T> in = make_input<T>( 0xFFF, SAMPLES + Channels * 101 );
+		const std::size_t frames = SAMPLES;
+
+		std::vector<T> interleaved( frames * Channels );
+		std::vector<T> expected( frames * Channels );
+
+		for( unsigned ch = 0; ch < Channels; ++ch ) {
+			const std::vector<T> channel_in( in.begin() + ch * 101, in.begin() + ch * 101 + frames );
+			const std::vector<T> channel_out = run_reference<T,C,N>( channel_in );
+
+			for( std::size_t i = 0; i < frames; ++i ) {
+				interleaved[i * Channels + ch] = channel_in[i];
+				expected[i * Channels + ch] = channel_out[i];
+			}
+		}
+
+		FilterBank<T,C,N,Channels> bank_single;
+
+		std::vector<T> single( interleaved.size() );
+
+		for( std::size_t i = 0; i < frames; ++i ) {
+			bank_single.add( std::span<const T>( interleaved ).subspan( i * Channels, Channels ) );
+			bank_single.calculate();
+
+			for( unsigned ch = 0; ch < Channels; ++ch ) {
+				single[i * Channels + ch] = bank_single.get_last_result( ch );
+			}
+		}
+
+		bool ok = compare( out, name + " single", expected, single );
+		ok = check_engine( out, name, []() { return FilterBank<T,C,N,Channels>(); }, interleaved, expected, 0, Channels ) && ok;
+
+		return ok;
+	}
+
+	/**
+	 * 4 threads with short chunks, so most blocks are split and
+	 * every chunk but the first is primed from the samples in front of it
+	 */
+	template<class FILTER, typename T>
+	bool check_parallel( std::ostream & out, const std::string & name,
+						 const FILTER & filter, const std::vector<T> & in, const std::vector<T> & expected )
+	{
+		const std::size_t chunk_size = std::max<std::size_t>( 64, internal::taps_of( filter ) );
+
+		return check_engine( out, name, [&]() { return ParallelFilter<FILTER>( 4, chunk_size, filter ); }, in, expected );
+	}
+
+	template<typename T, typename C, unsigned N>
+	bool check_parallel( std::ostream & out, const std::string & types, double amplitude )
+	{
+		const std::vector<T> in = make_input<T>( amplitude );
+		const std::vector<T> expected = run_reference<T,C,N>( in );
+		const std::string taps = std::to_string( N );
+
+		bool ok = check_parallel( out, "ParallelFilter<Filter<" + types + "," + taps + ">>",
+								  Filter<T,C,N>(), in, expected );
+		ok = check_parallel( out, "ParallelFilter<DynamicFilter<" + types + ">>( " + taps + " )",
+							 DynamicFilter<T,C>( N ), in, expected ) && ok;
+
+		return ok;
+	}
+
+	/**
+	 * one output of MultiOrderFilter as an engine of its own,
+	 * process() drops the other two
+	 */
+	template<typename T, typename C, unsigned N>
+	class MultiOrderOutput
+	{
+		typedef MultiOrderFilter<T,C,N> MULTI_ORDER_FILTER;
+
+		MULTI_ORDER_FILTER filter;
+		typename MULTI_ORDER_FILTER::Output output;
+
+	public:
+		explicit MultiOrderOutput( typename MULTI_ORDER_FILTER::Output output_ )
+		: output( output_ )
+		{
+		}
+
+		T operator()( T input )
+		{
+			const typename MULTI_ORDER_FILTER::Result r = filter( input );
+
+			switch( output ) {
+				case MULTI_ORDER_FILTER::SMOOTHED:         return r.smoothed;
+				case MULTI_ORDER_FILTER::FIRST_DERIVATIVE: return r.first_derivative;
+				default:                                   return r.second_derivative;
+			}
+		}
+
+		void process( std::span<const T> in, std::span<T> out )
+		{
+			std::vector<T> outputs[MULTI_ORDER_FILTER::OUTPUT_COUNT];
+
+			for( std::vector<T> & o : outputs ) {
+				o.resize( in.size() );
+			}
+
+			filter.process( in,
+							outputs[MULTI_ORDER_FILTER::SMOOTHED],
+							outputs[MULTI_ORDER_FILTER::FIRST_DERIVATIVE],
+							outputs[MULTI_ORDER_FILTER::SECOND_DERIVATIVE] );
+
+			std::copy( outputs[output].begin(), outputs[output].end(), out.begin() );
+		}
+	};
+
+	/**
+	 * The first derivative has to be the one of Filter. The smoothed value
+	 * and the second derivative have no reference, there process() has to
+	 * match the single samples.
+	 */
+	template<typename T, typename C, unsigned N>
+	bool check_multi_order( std::ostream & out, const std::string & name, double amplitude )
+	{
+		typedef MultiOrderFilter<T,C,N> MULTI_ORDER_FILTER;
+		typedef MultiOrderOutput<T,C,N> OUTPUT;
+
+		const std::vector<T> in = make_input<T>( amplitude );
+
+		bool ok = check_engine( out, name + " first derivative",
+								[]() { return OUTPUT( MULTI_ORDER_FILTER::FIRST_DERIVATIVE ); },
+								in, run_reference<T,C,N>( in ) );
+		ok = check_engine( out, name + " smoothed",
+						   []() { return OUTPUT( MULTI_ORDER_FILTER::SMOOTHED ); },
+						   in, run_single( OUTPUT( MULTI_ORDER_FILTER::SMOOTHED ), in ) ) && ok;
+		ok = check_engine( out, name + " second derivative",
+						   []() { return OUTPUT( MULTI_ORDER_FILTER::SECOND_DERIVATIVE ); },
+						   in, run_single( OUTPUT( MULTI_ORDER_FILTER::SECOND_DERIVATIVE ), in ) ) && ok;
+
+		return ok;
+	}
+
+	/**
+	 * taps have to be the exact taps, rounded once
+	 */
+	template<typename C, std::size_t N>
+	bool check_rounded_taps( std::ostream & out, const std::string & name,
+							 const std::array<int64_t, N> & exact, const std::array<C, N> & taps )
+	{
+		std::size_t mismatches = 0;
+
+		for( std::size_t k = 0; k < N; ++k ) {
+			if( taps[k] != static_cast<C>( exact[k] ) ) {
+				++mismatches;
+			}
+		}
+
+		out << name << ": ";
+
+		if( mismatches == 0 ) {
+			out << "OK";
+		} else {
+			out << "FAILED, " << mismatches << " taps differ";
+		}
+
+		out << std::endl;
+
+		return mismatches == 0;
+	}
+
+	/**
+	 * The smoothing and second derivative taps of float and double
+	 * are the int64_t ones, rounded once. The binomial coefficients of 55
+	 * taps do not fit into float, the ones of 63 taps not into double.
+	 */
+	template<unsigned N>
+	bool check_multi_order_taps( std::ostream & out )
+	{
+		typedef MultiOrderFilter<int64_t,int64_t,N> EXACT;
+		typedef MultiOrderFilter<float,float,N> FLOAT;
+		typedef MultiOrderFilter<double,double,N> DOUBLE;
+
+		const std::string size = "," + std::to_string( N ) + ">";
+
+		bool ok = check_rounded_taps( out, "MultiOrderFilter<float" + size + " smoothing taps",
+									  EXACT::get_smoothing_coefficients(), FLOAT::get_smoothing_coefficients() );
+		ok = check_rounded_taps( out, "MultiOrderFilter<double" + size + " smoothing taps",
+								 EXACT::get_smoothing_coefficients(), DOUBLE::get_smoothing_coefficients() ) && ok;
+		ok = check_rounded_taps( out, "MultiOrderFilter<float" + size + " second derivative taps",
+								 EXACT::get_second_derivative_coefficients(), FLOAT::get_second_derivative_coefficients() ) && ok;
+		ok = check_rounded_taps( out, "MultiOrderFilter<double" + size + " second derivative taps",
+								 EXACT::get_second_derivative_coefficients(), DOUBLE::get_second_derivative_coefficients() ) && ok;
+
+		return ok;
+	}
+
+	/**
+	 * one window of MultiWindowFilter as an engine of its own,
+	 * process() drops the other windows
+	 */
+	template<typename T, typename C, unsigned... Ns>
+	class MultiWindowOutput
+	{
+		typedef MultiWindowFilter<T,C,Ns...> MULTI_WINDOW_FILTER;
+		static constexpr unsigned windows = MULTI_WINDOW_FILTER::windows;
+
+		MULTI_WINDOW_FILTER filter;
+		unsigned window;
+
+	public:
+		explicit MultiWindowOutput( unsigned window_ )
+		: window( window_ )
+		{
+		}
+
+		T operator()( T input ) {
+			return filter( input )[window];
+		}
+
+		void process( std::span<const T> in, std::span<T> out )
+		{
+			std::vector<T> outputs[windows];
+			std::array<std::span<T>, windows> spans;
+
+			for( unsigned w = 0; w < windows; ++w ) {
+				outputs[w].resize( in.size() );
+				spans[w] = outputs[w];
+			}
+
+			filter.process( in, spans );
+
+			std::copy( outputs[window].begin(), outputs[window].end(), out.begin() );
+		}
+	};
+
+	/**
+	 * window w has to return the results of Filter<T,C,Ns[w]>
+	 */
+	template<typename T, typename C, unsigned... Ns>
+	bool check_multi_window( std::ostream & out, const std::string & name, double amplitude )
+	{
+		typedef MultiWindowFilter<T,C,Ns...> MULTI_WINDOW_FILTER;
+
+		const std::vector<T> in = make_input<T>( amplitude );
+		const std::vector<T> expected[] = { run_reference<T,C,Ns>( in )... };
+
+		bool ok = true;
+
+		for( unsigned w = 0; w < MULTI_WINDOW_FILTER::windows; ++w ) {
+			ok = check_engine( out, name + " N=" + std::to_string( MULTI_WINDOW_FILTER::window_sizes[w] ),
+							   [=]() { return MultiWindowOutput<T,C,Ns...>( w ); }, in, expected[w] ) && ok;
+		}
+
+		return ok;
+	}
+
+	/**
+	 * Pipeline as an engine with process(). The results ready so far are
+	 * popped right after the push, the rest after a flush(). The rings are
+	 * large enough, results which never come back are counted in lost.
+	 */
+	template<typename T, typename C, unsigned N>
+	class PipelineEngine
+	{
+		Pipeline<Filter<T,C,N>> pipeline;
+		std::size_t & lost;
+
+	public:
+		PipelineEngine( const PipelineConfig & config, std::size_t & lost_ )
+		: pipeline( config ),
+		  lost( lost_ )
+		{
+		}
+
+		void process( std::span<const T> in, std::span<T> out )
+		{
+			pipeline.push( in );
+
+			std::size_t popped = pipeline.pop( out.first( in.size() ) );
+
+			if( popped < in.size() ) {
+				pipeline.flush();
+				popped += pipeline.pop( out.subspan( popped, in.size() - popped ) );
+			}
+
+			lost += in.size() - popped;
+		}
+	};
+
+	template<typename T, typename C, unsigned N>
+	bool check_pipeline( std::ostream & out, const std::string & name, double amplitude,
+						 const PipelineConfig & config )
+	{
+		const std::vector<T> in = make_input<T>( amplitude );
+
+		std::size_t lost = 0;
+
+		bool ok = check_engine( out, name, [&]() { return PipelineEngine<T,C,N>( config, lost ); },
+								in, run_reference<T,C,N>( in ) );
+
+		if( lost != 0 ) {
+			out << name << ": FAILED, " << lost << " results lost" << std::endl;
+			ok = false;
+		}
+
+		return ok;
+	}
+
+	template<typename T, typename C, unsigned N>
+	bool check_pipeline( std::ostream & out, const std::string & name, double amplitude )
+	{
+		PipelineConfig config;
+		bool ok = check_pipeline<T,C,N>( out, name + " futex", amplitude, config );
+
+		config.wait = PipelineConfig::Wait::busy_poll;
+		config.batch_size = 7;
+		ok = check_pipeline<T,C,N>( out, name + " busy poll, batches of 7", amplitude, config ) && ok;
+
+		return ok;
+	}
+
+	/**
+	 * There is no Filter with these taps. The sums have to be the ones of
+	 * the direct form with get_coefficients(), process() has to match the
+	 * single samples and the derivative of a parabola has to be exact
+	 * at the newest sample. For floating point types exact means within
+	 * the rounding errors of the sum.
+	 */
+	template<typename T, typename C, unsigned N>
+	bool check_one_sided( std::ostream & out, const std::string & name, double amplitude )
+	{
+		typedef OneSidedFilter<T,C,N> ONE_SIDED_FILTER;
+
+		constexpr std::array<C, N> h = ONE_SIDED_FILTER::get_coefficients();
+
+		// the most a sum can be off by rounding, per unit of input
+		double rounding = 0;
+
+		if constexpr( std::is_floating_point_v<C> ) {
+			for( C tap : h ) {
+				rounding += N * std::numeric_limits<C>::epsilon() * std::abs( double( tap ) );
+			}
+		}
+
+		const std::vector<T> in = make_input<T>( amplitude );
+
+		std::vector<C> expected_sums( in.size() );
+		std::vector<C> sums( in.size() );
+
+		ONE_SIDED_FILTER filter;
+
+		for( std::size_t i = 0; i < in.size(); ++i ) {
+			C sum = 0;
+
+			for( unsigned k = 0; k < N && k <= i; ++k ) {
+				sum += h[k] * C( in[i - k] );
+			}
+
+			expected_sums[i] = sum;
+
+			filter.add( in[i] );
+			sums[i] = filter.calculate();
+		}
+
+		bool ok = compare( out, name + " sums", expected_sums, sums, rounding * amplitude );
+		ok = check_engine( out, name, []() { return ONE_SIDED_FILTER(); }, in, run_single( ONE_SIDED_FILTER(), in ) ) && ok;
+
+		// x[n] = 3 n^2 - 5 n + 7, x'[n] = 6 n - 5
+		constexpr std::size_t parabola_size = 1000;
+
+		std::vector<T> parabola( parabola_size );
+		std::vector<T> derivative( parabola.size() - ( N - 1 ) );
+
+		for( std::size_t n = 0; n < parabola.size(); ++n ) {
+			parabola[n] = T( 3 * n * n ) - T( 5 * n ) + T( 7 );
+		}
+
+		for( std::size_t n = N - 1; n < parabola.size(); ++n ) {
+			derivative[n - ( N - 1 )] = T( 6 * n ) - T( 5 );
+		}
+
+		const std::vector<T> parabola_results = run_single( ONE_SIDED_FILTER(), parabola );
+
+		ok = compare( out, name + " parabola", derivative,
+					  std::vector<T>( parabola_results.begin() + ( N - 1 ), parabola_results.end() ),
+					  rounding * 3 * parabola_size * parabola_size / double( ONE_SIDED_FILTER::calc_default_denominator() ) ) && ok;
+
+		return ok;
+	}
+
+	/**
+	 * process() continues the blocks, the stateless evaluate() gets
+	 * the input with N-1 zeros in front, like the empty delay line of Filter
+	 */
+	template<typename T, typename C, unsigned N>
+	bool check_view( std::ostream & out, const std::string & name, double amplitude )
+	{
+		typedef FilterView<T,C,N> FILTER_VIEW;
+
+		const std::vector<T> in = make_input<T>( amplitude );
+		const std::vector<T> expected = run_reference<T,C,N>( in );
+
+		std::vector<T> padded( N - 1 + in.size(), T(0) );
+		std::copy( in.begin(), in.end(), padded.begin() + ( N - 1 ) );
+
+		const FILTER_VIEW stateless;
+
+		std::vector<T> single( in.size() );
+		std::vector<T> whole( in.size() );
+
+		for( std::size_t i = 0; i < in.size(); ++i ) {
+			single[i] = stateless.evaluate( std::span<const T>( padded ).subspan( i, N ) );
+		}
+
+		stateless.evaluate( padded, whole );
+
+		bool ok = check_engine( out, name, []() { return FILTER_VIEW(); }, in, expected );
+		ok = compare( out, name + " evaluate single", expected, single ) && ok;
+		ok = compare( out, name + " evaluate", expected, whole ) && ok;
+
+		return ok;
+	}
+
+	/**
+	 * sum( |tap[i] * ( x[N-1-i] - x[i] )| ) for every window of in, with the
+	 * normalized taps of Filter<double,double,N> and N-1 zeros in front of in.
+	 * The rounding errors of the sums are bounded relative to it.
+	 */
+	template<typename T, unsigned N>
+	std::vector<double> calc_abs_sums( const std::vector<T> & in )
+	{
+		constexpr std::array<double, N/2> folded = Filter<double,double,N>::calc_folded_coefficients();
+		constexpr double denominator = Filter<double,double,N>::calc_default_denominator();
+
+		std::vector<double> padded( N - 1 + in.size(), 0 );
+		std::copy( in.begin(), in.end(), padded.begin() + ( N - 1 ) );
+
+		std::vector<double> abs_sums( in.size() );
+
+		for( std::size_t k = 0; k < in.size(); ++k ) {
+			const double * x = &padded[k];
+			double sum = 0;
+
+			for( unsigned i = 0; i < N/2; ++i ) {
+				sum += std::abs( folded[i] / denominator * ( x[N-1-i] - x[i] ) );
+			}
+
+			abs_sums[k] = sum;
+		}
+
+		return abs_sums;
+	}
+
+	/**
+	 * Against Filter<double,double,N>, within the error bounds of SNRDCompensated.hpp.
+	 * process() has to match the single samples.
+	 */
+	template<typename T, typename C, unsigned N, Accumulation mode>
+	bool check_compensated( std::ostream & out, const std::string & name )
+	{
+		typedef CompensatedFilter<T,C,N,mode> COMPENSATED_FILTER;
+
+		constexpr double ulps = mode == Accumulation::compensated ? exmath::Filter::simd::compensation_block + 3 : N/2 + 1;
+
+		// the taps flushed to 0 contribute less than 1e-35 per unit of input
+		constexpr double amplitude = 0xFFF;
+		constexpr double flushed = 2 * amplitude * 1e-35;
+
+		const std::vector<T> in = make_input<T>( amplitude );
+		const std::vector<double> expected = run_reference<double,double,N>( std::vector<double>( in.begin(), in.end() ) );
+
+		std::vector<double> tolerances = calc_abs_sums<T,N>( in );
+
+		for( double & tolerance : tolerances ) {
+			tolerance = tolerance * ulps * std::numeric_limits<C>::epsilon() + flushed;
+		}
+
+		const std::vector<T> single = run_single( COMPENSATED_FILTER(), in );
+
+		bool ok = compare( out, name + " against double", expected, std::vector<double>( single.begin(), single.end() ), tolerances );
+		ok = check_engine( out, name, []() { return COMPENSATED_FILTER(); }, in, single ) && ok;
+
+		return ok;
+	}
+
+	/**
+	 * The result for in[k] has to be the one of Filter<double,double,N> for
+	 * in[k + (N-M)/2], within the truncation error and the rounding errors.
+	 * The tolerance lets the dropped taps add about as much error as the
+	 * rounding. DynamicTruncatedFilter has to choose the same taps and
+	 * return exactly the same results.
+	 */
+	template<typename T, typename C, unsigned N>
+	bool check_truncated( std::ostream & out, const std::string & types )
+	{
+		constexpr C max_input = 0xFFF;
+		constexpr C tolerance = max_input * 64 * std::numeric_limits<C>::epsilon();
+		constexpr unsigned M = truncated_taps<C,N>( max_input, tolerance );
+		constexpr std::size_t delay = ( N - M ) / 2;
+
+		typedef TruncatedFilter<T,C,N,M> TRUNCATED_FILTER;
+
+		const std::vector<T> in = make_input<T>( max_input );
+		const std::vector<double> reference = run_reference<double,double,N>( std::vector<double>( in.begin(), in.end() ) );
+		const std::vector<double> abs_sums = calc_abs_sums<T,N>( in );
+
+		const std::vector<double> expected( reference.begin() + delay, reference.end() );
+		std::vector<double> tolerances( expected.size() );
+
+		for( std::size_t k = 0; k < expected.size(); ++k ) {
+			tolerances[k] = TRUNCATED_FILTER::truncation_error( max_input )
+						  + ( M/2 + 1 ) * std::numeric_limits<C>::epsilon() * abs_sums[k + delay];
+		}
+
+		const std::vector<T> truncated = run_single( TRUNCATED_FILTER(), in );
+
+		const std::string truncated_name = "TruncatedFilter<" + types + "," + std::to_string( N ) + "," + std::to_string( M ) + ">";
+
+		bool ok = compare( out, truncated_name + " against double", expected,
+						   std::vector<double>( truncated.begin(), truncated.end() - delay ), tolerances );
+		ok = check_engine( out, truncated_name, []() { return TRUNCATED_FILTER(); }, in, truncated ) && ok;
+
+		const std::string dynamic_name = "DynamicTruncatedFilter<" + types + ">( " + std::to_string( N ) + " )";
+		const unsigned dynamic_taps = DynamicTruncatedFilter<T,C>( N, max_input, tolerance ).get_taps();
+
+		if( dynamic_taps != M ) {
+			out << dynamic_name << ": FAILED, " << dynamic_taps << " taps instead of " << M << std::endl;
+			return false;
+		}
+
+		ok = check_engine( out, dynamic_name, [=]() { return DynamicTruncatedFilter<T,C>( N, max_input, tolerance ); },
+						   in, truncated ) && ok;
+
+		return ok;
+	}
+
+} // namespace
+
+bool check_engines( std::ostream & out )
+{
+	bool ok = true;
+
+	ok = check_process<int32_t,int32_t,6*2+1>( out, "Filter<int32_t,int32_t,13>", 0xFFF ) && ok;
+	ok = check_process<float,float,13*2+1>( out, "Filter<float,float,27>", 4 ) && ok;
+	ok = check_process<double,double,27*2+1>( out, "Filter<double,double,55>", 4 ) && ok;
+
+	ok = check_folded<int32_t,int32_t,6*2+1>( out, "Filter<int32_t,int32_t,13>", 0xFFF ) && ok;
+	ok = check_folded<int16_t,int64_t,27*2+1>( out, "Filter<int16_t,int64_t,55>", 0xFFF ) && ok;
+	ok = check_folded<float,float,13*2+1>( out, "Filter<float,float,27>", 4 ) && ok;
+	ok = check_folded<double,double,63*2+1>( out, "Filter<double,double,127>", 4 ) && ok;
+
+	ok = check_fir_filter<int32_t,int32_t,16>( out, "FIRFilter<int32_t,int32_t,16>", 0xFFF ) && ok;
+	ok = check_fir_filter<int16_t,int64_t,7>( out, "FIRFilter<int16_t,int64_t,7>", 0xFFF ) && ok;
+	ok = check_fir_filter<float,float,127>( out, "FIRFilter<float,float,127>", 4 ) && ok;
+	ok = check_fir_filter<double,double,55>( out, "FIRFilter<double,double,55>", 4 ) && ok;
+	ok = check_fir_filter<float,double,8>( out, "FIRFilter<float,double,8>", 4 ) && ok;
+
+	ok = check_decimated<int32_t,int32_t,6*2+1>( out, "Filter<int32_t,int32_t,13>", 0xFFF, 4 ) && ok;
+	ok = check_decimated<float,float,13*2+1>( out, "Filter<float,float,27>", 4, 10 ) && ok;
+	ok = check_decimated<double,double,63*2+1>( out, "Filter<double,double,127>", 4, 3 ) && ok;
+	ok = check_cache<int32_t,int32_t,6*2+1>( out, "Filter<int32_t,int32_t,13>", 0xFFF ) && ok;
+	ok = check_cache<double,double,27*2+1>( out, "Filter<double,double,55>", 4 ) && ok;
+
+	ok = check_normalizer<int32_t>( out, "Normalizer<int32_t>" ) && ok;
+	ok = check_normalizer<int64_t>( out, "Normalizer<int64_t>" ) && ok;
+	ok = check_normalized<float,float,13*2+1>( out, "NormalizedFilter<float,float,27>", 0xFFF ) && ok;
+	ok = check_normalized<double,double,63*2+1>( out, "NormalizedFilter<double,double,127>", 0xFFF ) && ok;
+
+	ok = check_make_filter<5*2+1,12,int16_t,int32_t>( out ) && ok;
+	ok = check_make_filter<10*2+1,12,int16_t,int32_t>( out ) && ok;
+	ok = check_make_filter<15*2+1,15,int16_t,int64_t>( out ) && ok;
+	ok = check_make_filter<13*2+1,20,int32_t,int64_t>( out ) && ok;
+	ok = check_make_filter<27*2+1,10,int16_t,int64_t>( out ) && ok;
+	ok = check_make_filter<31*2+1,4,int16_t,int64_t>( out ) && ok;
+
+	ok = check_unrolled<int32_t,int32_t,2*2+1>( out, "int32_t,int32_t", 0xFFF ) && ok;
+	ok = check_unrolled<int16_t,int64_t,15*2+1>( out, "int16_t,int64_t", 0xFFF ) && ok;
+	ok = check_unrolled<float,float,13*2+1>( out, "float,float", 4 ) && ok;
+	ok = check_unrolled<double,double,15*2+1>( out, "double,double", 4 ) && ok;
+
+	ok = check_delay_lines<8>( out ) && ok;
+	ok = check_delay_lines<7>( out ) && ok;
+	ok = check_delay_line_policies<int32_t,int32_t,3*2+1>( out, "int32_t,int32_t", 0xFFF ) && ok;
+	ok = check_delay_line_policies<float,float,13*2+1>( out, "float,float", 4 ) && ok;
+	ok = check_delay_line_policies<double,double,16*2+1>( out, "double,double", 4 ) && ok;
+	ok = check_fir_filter<int32_t,int32_t,16,exmath::Filter::MaskedDelayLine<int32_t,16>>( out, "FIRFilter<int32_t,int32_t,16,MaskedDelayLine>", 0xFFF ) && ok;
+	ok = check_fir_filter<float,float,8,exmath::Filter::MaskedDelayLine<float,8>>( out, "FIRFilter<float,float,8,MaskedDelayLine>", 4 ) && ok;
+	ok = check_fir_filter<double,double,7,exmath::Filter::MaskedDelayLine<double,7>>( out, "FIRFilter<double,double,7,MaskedDelayLine>", 4 ) && ok;
+	ok = check_fir_filter<float,float,8,exmath::Filter::ShiftDelayLine<float,8>>( out, "FIRFilter<float,float,8,ShiftDelayLine>", 4 ) && ok;
+	ok = check_fir_filter<int16_t,int32_t,7,exmath::Filter::ShiftDelayLine<int16_t,7>>( out, "FIRFilter<int16_t,int32_t,7,ShiftDelayLine>", 0xFFF ) && ok;
+
+	ok = check_cascade<int64_t,int64_t,27*2+1>( out, "CascadeFilter<int64_t,int64_t,55>" ) && ok;
+	ok = check_cascade<int32_t,int32_t,5*2+1>( out, "CascadeFilter<int32_t,int32_t,11>" ) && ok;
+
+	ok = check_fft<double,double,397*2+1>( out, "<double,double,795>", 1 << 17 ) && ok;
+	ok = check_fft<float,float,63*2+1>( out, "<float,float,127>", 1 << 15 ) && ok;
+
+	ok = check_filter_bank<int32_t,int32_t,5*2+1,64>( out, "FilterBank<int32_t,int32_t,11,64>" ) && ok;
+	ok = check_filter_bank<float,float,27*2+1,7>( out, "FilterBank<float,float,55,7>" ) && ok;
+	ok = check_filter_bank<double,double,13*2+1,3>( out, "FilterBank<double,double,27,3>" ) && ok;
+
+	ok = check_parallel<int64_t,int64_t,27*2+1>( out, "int64_t,int64_t", 0xFFF ) && ok;
+	ok = check_parallel<double,double,397*2+1>( out, "double,double", 4 ) && ok;
+
+	ok = check_multi_order<int64_t,int64_t,13*2+1>( out, "MultiOrderFilter<int64_t,int64_t,27>", 0xFFF ) && ok;
+	ok = check_multi_order<float,float,13*2+1>( out, "MultiOrderFilter<float,float,27>", 4 ) && ok;
+	ok = check_multi_order<double,double,63*2+1>( out, "MultiOrderFilter<double,double,127>", 4 ) && ok;
+	ok = check_multi_order_taps<27*2+1>( out ) && ok;
+	ok = check_multi_order_taps<31*2+1>( out ) && ok;
+
+	ok = check_multi_window<int32_t,int32_t,5,11,21>( out, "MultiWindowFilter<int32_t,int32_t,5,11,21>", 0xFFF ) && ok;
+	ok = check_multi_window<float,float,11,27,55,127>( out, "MultiWindowFilter<float,float,11,27,55,127>", 4 ) && ok;
+	ok = check_multi_window<double,double,55,27>( out, "MultiWindowFilter<double,double,55,27>", 4 ) && ok;
+
+	ok = check_pipeline<int64_t,int64_t,27*2+1>( out, "Pipeline<Filter<int64_t,int64_t,55>>", 0xFFF ) && ok;
+	ok = check_pipeline<float,float,63*2+1>( out, "Pipeline<Filter<float,float,127>>", 4 ) && ok;
+
+	ok = check_one_sided<int64_t,int64_t,15>( out, "OneSidedFilter<int64_t,int64_t,15>", 0xFFF ) && ok;
+	ok = check_one_sided<int32_t,int32_t,5>( out, "OneSidedFilter<int32_t,int32_t,5>", 0xFFF ) && ok;
+	ok = check_one_sided<double,double,55>( out, "OneSidedFilter<double,double,55>", 4 ) && ok;
+
+	ok = check_view<int32_t,int64_t,27*2+1>( out, "FilterView<int32_t,int64_t,55>", 0xFFF ) && ok;
+	ok = check_view<int16_t,int32_t,5*2+1>( out, "FilterView<int16_t,int32_t,11>", 0xFFF ) && ok;
+	ok = check_view<float,float,63*2+1>( out, "FilterView<float,float,127>", 4 ) && ok;
+	ok = check_view<double,double,397*2+1>( out, "FilterView<double,double,795>", 4 ) && ok;
+
+	ok = check_compensated<float,float,397*2+1,Accumulation::compensated>( out, "CompensatedFilter<float,float,795,compensated>" ) && ok;
+	ok = check_compensated<float,float,397*2+1,Accumulation::ordered>( out, "CompensatedFilter<float,float,795,ordered>" ) && ok;
+	ok = check_compensated<double,double,63*2+1,Accumulation::compensated>( out, "CompensatedFilter<double,double,127,compensated>" ) && ok;
+
+	ok = check_truncated<double,double,397*2+1>( out, "double,double" ) && ok;
+	ok = check_truncated<float,float,127*2+1>( out, "float,float" ) && ok;
+
+	return ok;
+}
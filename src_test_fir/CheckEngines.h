@@ -0,0 +1,22 @@
+/*
+ * CheckEngines.h
+ *
+ * Compares the results of the filter engines with the ones of
+ * Filter<T,C,N>, for single samples and for process() with
+ * blocks of different sizes.
+ *
+ * Engines which claim to return the results of Filter have to be bit
+ * identical, the others have to stay within their error bound.
+ */
+
+#ifndef TEST_FIR_CHECK_ENGINES_H
+#define TEST_FIR_CHECK_ENGINES_H
+
+#include <ostream>
+
+/**
+ * prints one line per check, returns true if all checks passed
+ */
+bool check_engines( std::ostream & out );
+
+#endif
@@ -0,0 +1,367 @@
+/*
+ * CheckSampleIO.cc
+ */
+
+#include "CheckSampleIO.h"
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "SampleIO.h"
+
+namespace {
+
+	// TextSampleReader reads in chunks of this size
+	constexpr std::size_t TEXT_CHUNK_SIZE = 1024 * 1024;
+
+	const SampleFormat BINARY_FORMATS[] = {
+		SampleFormat::int16,
+		SampleFormat::int32,
+		SampleFormat::float32,
+		SampleFormat::float64
+	};
+
+	/**
+	 * removes the file again when the check is done
+	 */
+	class TempFile
+	{
+		std::filesystem::path path;
+
+	public:
+		explicit TempFile( const std::string & name )
+		: path( std::filesystem::temp_directory_path() / ( "test_fir_check_io_" + name ) )
+		{
+		}
+
+		~TempFile() {
+			std::error_code ec;
+			std::filesystem::remove( path, ec );
+		}
+
+		TempFile( const TempFile & other ) = delete;
+		TempFile & operator=( const TempFile & other ) = delete;
+
+		std::string get_name() const {
+			return path.string();
+		}
+
+		void write( const std::string & data ) const {
+			std::ofstream( path, std::ios::binary | std::ios::trunc ).write( data.data(), data.size() );
+		}
+
+		std::string read() const {
+			std::ifstream in( path, std::ios::binary );
+			return std::string( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+		}
+	};
+
+	/**
+	 * reads in blocks of 1000 samples, so the end of the data
+	 * falls into the middle of a block
+	 */
+	std::vector<double> read_all( SampleReader & reader )
+	{
+		std::vector<double> samples;
+		std::vector<double> block( 1000 );
+
+		while( std::size_t count = reader.read( block ) ) {
+			samples.insert( samples.end(), block.begin(), block.begin() + count );
+		}
+
+		return samples;
+	}
+
+	/**
+	 * integers in the range of int16, so every format stores them exactly
+	 */
+	std::vector<double> make_samples( std::size_t count )
+	{
+		std::vector<double> samples( count );
+
+		for( std::size_t i = 0; i < count; ++i ) {
+			samples[i] = static_cast<double>( ( i * 7919 ) % 65536 ) - 32768;
+		}
+
+		return samples;
+	}
+
+	void write_binary( const TempFile & file, SampleFormat format, bool write_header, const std::vector<double> & samples )
+	{
+		BinarySampleWriter writer( file.get_name(), format, write_header );
+		writer.write( samples );
+		writer.flush();
+	}
+
+	bool report( std::ostream & out, const std::string & name,
+				 const std::vector<double> & expected, const std::vector<double> & result )
+	{
+		out << name << ": ";
+
+		if( result == expected ) {
+			out << "OK";
+		} else if( result.size() != expected.size() ) {
+			out << "FAILED, " << result.size() << " samples instead of " << expected.size();
+		} else {
+			std::size_t mismatches = 0;
+
+			for( std::size_t i = 0; i < expected.size(); ++i ) {
+				if( result[i] != expected[i] ) {
+					++mismatches;
+				}
+			}
+
+			out << "FAILED, " << mismatches << " of " << expected.size() << " samples differ";
+		}
+
+		out << std::endl;
+
+		return result == expected;
+	}
+
+	/**
+	 * an exception fails the check instead of ending all of them
+	 */
+	template<class CHECK>
+	bool run_check( std::ostream & out, const std::string & name, CHECK check )
+	{
+		try {
+			return check();
+		} catch( const std::exception & error ) {
+			out << name << ": FAILED, " << error.what() << std::endl;
+			return false;
+		}
+	}
+
+	/**
+	 * Without a header the given format is used, with one the format of
+	 * the header, so the reader gets a wrong one then. The header has to
+	 * be written once and produce no sample.
+	 */
+	bool check_binary_round_trip( std::ostream & out, SampleFormat format, bool write_header )
+	{
+		const std::string name = std::string( "binary " ) + sample_format_name( format )
+								 + ( write_header ? " with header" : "" );
+
+		return run_check( out, name, [&]() {
+			const TempFile file( "round_trip" );
+			const std::vector<double> samples = make_samples( 3000 );
+
+			write_binary( file, format, write_header, samples );
+
+			const std::size_t expected_size = samples.size() * sample_format_size( format )
+											  + ( write_header ? SampleHeader::SIZE : 0 );
+
+			if( file.read().size() != expected_size ) {
+				out << name << ": FAILED, " << file.read().size() << " bytes instead of " << expected_size << std::endl;
+				return false;
+			}
+
+			const SampleFormat read_format = write_header
+					? ( format == SampleFormat::int16 ? SampleFormat::float64 : SampleFormat::int16 )
+					: format;
+
+			BinarySampleReader reader( file.get_name(), read_format );
+
+			if( reader.get_format() != format ) {
+				out << name << ": FAILED, read as " << sample_format_name( reader.get_format() ) << std::endl;
+				return false;
+			}
+
+			return report( out, name, samples, read_all( reader ) );
+		} );
+	}
+
+	/**
+	 * an empty file and a file with nothing but a header give no samples
+	 */
+	bool check_binary_empty( std::ostream & out, bool write_header )
+	{
+		const std::string name = write_header ? "binary header only" : "binary empty file";
+
+		return run_check( out, name, [&]() {
+			const TempFile file( "empty" );
+
+			write_binary( file, SampleFormat::int32, write_header, {} );
+
+			BinarySampleReader reader( file.get_name(), SampleFormat::int32 );
+
+			return report( out, name, {}, read_all( reader ) );
+		} );
+	}
+
+	/**
+	 * the truncated last sample is dropped
+	 */
+	bool check_binary_truncated( std::ostream & out, SampleFormat format )
+	{
+		const std::string name = std::string( "binary " ) + sample_format_name( format ) + " truncated";
+
+		return run_check( out, name, [&]() {
+			const TempFile file( "truncated" );
+			const std::vector<double> samples = make_samples( 5 );
+
+			write_binary( file, format, false, samples );
+			file.write( file.read() + std::string( sample_format_size( format ) - 1, '\x7f' ) );
+
+			BinarySampleReader reader( file.get_name(), format );
+
+			return report( out, name, samples, read_all( reader ) );
+		} );
+	}
+
+	/**
+	 * "-" reads stdin into memory instead of mapping it
+	 */
+	bool check_binary_stdin( std::ostream & out, bool write_header )
+	{
+		const std::string name = std::string( "binary stdin" ) + ( write_header ? " with header" : "" );
+
+		return run_check( out, name, [&]() {
+			const TempFile file( "stdin" );
+			const std::vector<double> samples = make_samples( 3000 );
+
+			write_binary( file, SampleFormat::int16, write_header, samples );
+
+			if( !std::freopen( file.get_name().c_str(), "rb", stdin ) ) {
+				out << name << ": FAILED, cannot redirect stdin" << std::endl;
+				return false;
+			}
+
+			BinarySampleReader reader( "-", SampleFormat::int16 );
+
+			return report( out, name, samples, read_all( reader ) );
+		} );
+	}
+
+	/**
+	 * what test_fir read before TextSampleReader, with in >> f_in
+	 */
+	std::vector<double> read_with_stream( const TempFile & file )
+	{
+		std::ifstream in( file.get_name() );
+		std::vector<double> samples;
+		float f_in = 0;
+
+		while( in >> f_in ) {
+			samples.push_back( f_in );
+		}
+
+		return samples;
+	}
+
+	/**
+	 * Numbers in all notations with mixed whitespace. One token starts 5
+	 * bytes before the end of the first chunk, the last one has no
+	 * newline after it.
+	 */
+	std::string make_text( std::size_t min_size )
+	{
+		const char * const separators[] = { "\n", " ", "\t", "\r\n", "  \n" };
+		const char * const formats[] = { "%.1g", "%.9g", "%+.4f", "%.3e", "%.6g", "%g" };
+
+		std::string text;
+		char token[64];
+
+		for( unsigned i = 0; text.size() < min_size; ++i ) {
+			if( text.size() + 40 > TEXT_CHUNK_SIZE && text.size() < TEXT_CHUNK_SIZE ) {
+				text.append( TEXT_CHUNK_SIZE - 5 - text.size(), ' ' );
+				text += "-1234.5678e-3\n";
+			}
+
+			const double value = std::sin( i * 0.37 ) * std::pow( 10.0, int( i % 7 ) - 3 );
+
+			std::snprintf( token, sizeof(token), formats[i % std::size( formats )], value );
+			text += token;
+			text += separators[i % std::size( separators )];
+		}
+
+		return text + "0.000123456";
+	}
+
+	/**
+	 * the samples have to be the ones in >> f_in reads
+	 */
+	bool check_text( std::ostream & out, const std::string & name, const std::string & text, bool from_stdin )
+	{
+		return run_check( out, name, [&]() {
+			const TempFile file( "text" );
+
+			file.write( text );
+
+			if( from_stdin && !std::freopen( file.get_name().c_str(), "r", stdin ) ) {
+				out << name << ": FAILED, cannot redirect stdin" << std::endl;
+				return false;
+			}
+
+			TextSampleReader reader( from_stdin ? "-" : file.get_name() );
+
+			return report( out, name, read_with_stream( file ), read_all( reader ) );
+		} );
+	}
+
+	/**
+	 * TextSampleWriter has to write what std::cout << s writes
+	 */
+	bool check_text_writer( std::ostream & out )
+	{
+		const std::string name = "text writer";
+
+		return run_check( out, name, [&]() {
+			const TempFile file( "text_writer" );
+
+			std::vector<double> samples = make_samples( 3000 );
+			std::ostringstream expected;
+
+			for( std::size_t i = 0; i < samples.size(); ++i ) {
+				samples[i] = samples[i] * std::pow( 10.0, int( i % 13 ) - 9 );
+				expected << samples[i] << '\n';
+			}
+
+			{
+				TextSampleWriter writer( file.get_name() );
+				writer.write( samples );
+			}
+
+			const bool ok = file.read() == expected.str();
+
+			out << name << ": " << ( ok ? "OK" : "FAILED, the output differs from std::ostream" ) << std::endl;
+
+			return ok;
+		} );
+	}
+
+} // namespace
+
+bool check_sample_io( std::ostream & out )
+{
+	bool ok = true;
+
+	for( SampleFormat format : BINARY_FORMATS ) {
+		ok = check_binary_round_trip( out, format, false ) && ok;
+		ok = check_binary_round_trip( out, format, true ) && ok;
+	}
+
+	ok = check_binary_empty( out, false ) && ok;
+	ok = check_binary_empty( out, true ) && ok;
+
+	for( SampleFormat format : BINARY_FORMATS ) {
+		ok = check_binary_truncated( out, format ) && ok;
+	}
+
+	ok = check_binary_stdin( out, false ) && ok;
+	ok = check_binary_stdin( out, true ) && ok;
+
+	ok = check_text( out, "text empty file", "", false ) && ok;
+	ok = check_text( out, "text without trailing newline", "1.5\n+2.25 -3\n\n4e-2", false ) && ok;
+	ok = check_text( out, "text across chunks", make_text( TEXT_CHUNK_SIZE * 5 / 2 ), false ) && ok;
+	ok = check_text( out, "text stdin across chunks", make_text( TEXT_CHUNK_SIZE * 5 / 2 ), true ) && ok;
+	ok = check_text_writer( out ) && ok;
+
+	return ok;
+}
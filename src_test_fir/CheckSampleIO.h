@@ -0,0 +1,20 @@
+/*
+ * CheckSampleIO.h
+ *
+ * Writes sample files to the temp directory and reads them back
+ * with the readers of SampleIO, from the file and from stdin.
+ * Text input has to give the samples in >> float gives.
+ */
+
+#ifndef TEST_FIR_CHECK_SAMPLE_IO_H
+#define TEST_FIR_CHECK_SAMPLE_IO_H
+
+#include <ostream>
+
+/**
+ * prints one line per check, returns true if all checks passed.
+ * Redirects stdin to the checked files.
+ */
+bool check_sample_io( std::ostream & out );
+
+#endif
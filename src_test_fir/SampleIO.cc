@@ -0,0 +1,540 @@
+/*
+ * SampleIO.cc
+ */
+
+#include "SampleIO.h"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <stderr_exception.h>
+#include <format.h>
+
+#ifdef WIN32
+#  include <fcntl.h>
+#  include <io.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace {
+
+	// 1 MiB buffers, so every fread() and fwrite() moves a big block
+	constexpr std::size_t READ_BUFFER_SIZE = 1024 * 1024;
+	constexpr std::size_t WRITE_BUFFER_SIZE = 1024 * 1024;
+
+	// longest number written by TextSampleWriter, including the newline
+	constexpr std::size_t MAX_TEXT_SAMPLE_SIZE = 32;
+
+	bool is_std_stream( const std::string & file_name )
+	{
+		return file_name.empty() || file_name == "-";
+	}
+
+	std::FILE * open_output( const std::string & file_name, bool binary, bool & close_file )
+	{
+		close_file = false;
+
+		if( is_std_stream( file_name ) ) {
+#ifdef WIN32
+			if( binary ) {
+				_setmode( _fileno( stdout ), _O_BINARY );
+			}
+#endif
+			return stdout;
+		}
+
+		std::FILE * file = std::fopen( file_name.c_str(), binary ? "wb" : "w" );
+
+		if( !file ) {
+			throw STDERR_EXCEPTION( Tools::format( "cannot open file %s for writing", file_name ) );
+		}
+
+		close_file = true;
+
+		return file;
+	}
+
+	void write_all( std::FILE * file, const void * data, std::size_t size )
+	{
+		if( size > 0 && std::fwrite( data, 1, size, file ) != size ) {
+			throw STDERR_EXCEPTION( "writing samples failed" );
+		}
+
+		std::fflush( file );
+	}
+
+	bool is_space( char c )
+	{
+		return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+	}
+
+	template<class T>
+	T load_le( const unsigned char * p )
+	{
+		typedef std::conditional_t<sizeof(T) == 2, uint16_t,
+				std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>> U;
+
+		U u;
+		std::memcpy( &u, p, sizeof(U) );
+
+		if constexpr( std::endian::native == std::endian::big ) {
+			u = std::byteswap( u );
+		}
+
+		return std::bit_cast<T>( u );
+	}
+
+	template<class T>
+	void store_le( unsigned char * p, T value )
+	{
+		typedef std::conditional_t<sizeof(T) == 2, uint16_t,
+				std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>> U;
+
+		U u = std::bit_cast<U>( value );
+
+		if constexpr( std::endian::native == std::endian::big ) {
+			u = std::byteswap( u );
+		}
+
+		std::memcpy( p, &u, sizeof(U) );
+	}
+
+	template<class T>
+	T to_integer( double value )
+	{
+		if( std::isnan( value ) ) {
+			return 0;
+		}
+
+		value = std::round( value );
+		value = std::clamp( value,
+							double(std::numeric_limits<T>::min()),
+							double(std::numeric_limits<T>::max()) );
+
+		return static_cast<T>( value );
+	}
+
+} // namespace
+
+SampleFormat parse_sample_format( const std::string & name )
+{
+	if( name == "text" ) {
+		return SampleFormat::text;
+	} else if( name == "int16" ) {
+		return SampleFormat::int16;
+	} else if( name == "int32" ) {
+		return SampleFormat::int32;
+	} else if( name == "float" ) {
+		return SampleFormat::float32;
+	} else if( name == "double" ) {
+		return SampleFormat::float64;
+	}
+
+	throw STDERR_EXCEPTION( Tools::format( "unknown sample format '%s'", name ) );
+}
+
+const char * sample_format_name( SampleFormat format )
+{
+	switch( format ) {
+	case SampleFormat::text:    return "text";
+	case SampleFormat::int16:   return "int16";
+	case SampleFormat::int32:   return "int32";
+	case SampleFormat::float32: return "float";
+	case SampleFormat::float64: return "double";
+	}
+
+	return "unknown";
+}
+
+std::size_t sample_format_size( SampleFormat format )
+{
+	switch( format ) {
+	case SampleFormat::text:    return 0;
+	case SampleFormat::int16:   return 2;
+	case SampleFormat::int32:   return 4;
+	case SampleFormat::float32: return 4;
+	case SampleFormat::float64: return 8;
+	}
+
+	return 0;
+}
+
+bool SampleHeader::load( std::span<const unsigned char> data, const std::string & file_name )
+{
+	if( data.size() < SIZE || std::memcmp( data.data(), MAGIC, sizeof(MAGIC) ) != 0 ) {
+		return false;
+	}
+
+	version = load_le<uint16_t>( data.data() + 4 );
+
+	if( version != VERSION ) {
+		throw STDERR_EXCEPTION( Tools::format( "%s: unsupported header version %d", file_name, version ) );
+	}
+
+	format = static_cast<SampleFormat>( load_le<uint16_t>( data.data() + 6 ) );
+
+	if( sample_format_size( format ) == 0 ) {
+		throw STDERR_EXCEPTION( Tools::format( "%s: invalid sample format %d in header", file_name,
+											   static_cast<unsigned>( format ) ) );
+	}
+
+	return true;
+}
+
+void SampleHeader::store( unsigned char * data ) const
+{
+	if( version != VERSION || sample_format_size( format ) == 0 ) {
+		throw STDERR_EXCEPTION( "invalid sample header" );
+	}
+
+	std::memcpy( data, MAGIC, sizeof(MAGIC) );
+	store_le<uint16_t>( data + 4, version );
+	store_le<uint16_t>( data + 6, static_cast<uint16_t>( format ) );
+}
+
+MappedFile::MappedFile( const std::string & file_name )
+{
+	if( file_name == "-" ) {
+#ifdef WIN32
+		_setmode( _fileno( stdin ), _O_BINARY );
+#endif
+		unsigned char chunk[4096];
+		std::size_t len;
+
+		while( ( len = std::fread( chunk, 1, sizeof(chunk), stdin ) ) > 0 ) {
+			buffer.insert( buffer.end(), chunk, chunk + len );
+		}
+
+		data = buffer.data();
+		size = buffer.size();
+		return;
+	}
+
+#ifdef WIN32
+	std::ifstream in( file_name, std::ios::binary );
+
+	if( !in ) {
+		throw STDERR_EXCEPTION( Tools::format( "cannot open file %s", file_name ) );
+	}
+
+	buffer.assign( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+	data = buffer.data();
+	size = buffer.size();
+#else
+	const int fd = ::open( file_name.c_str(), O_RDONLY );
+
+	if( fd < 0 ) {
+		throw STDERR_EXCEPTION( Tools::format( "cannot open file %s", file_name ) );
+	}
+
+	struct stat st;
+
+	if( ::fstat( fd, &st ) != 0 ) {
+		::close( fd );
+		throw STDERR_EXCEPTION( Tools::format( "cannot stat file %s", file_name ) );
+	}
+
+	size = st.st_size;
+
+	// mmap() refuses to map 0 bytes
+	if( size > 0 ) {
+		void * p = ::mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+		if( p == MAP_FAILED ) {
+			::close( fd );
+			throw STDERR_EXCEPTION( Tools::format( "cannot map file %s", file_name ) );
+		}
+
+		::madvise( p, size, MADV_SEQUENTIAL );
+		data = static_cast<const unsigned char*>( p );
+	}
+
+	// the mapping stays valid after closing the file
+	::close( fd );
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef WIN32
+	if( data && buffer.empty() ) {
+		::munmap( const_cast<unsigned char*>( data ), size );
+	}
+#endif
+}
+
+TextSampleReader::TextSampleReader( const std::string & file_name )
+: file( stdin ),
+  close_file( false ),
+  buffer( READ_BUFFER_SIZE )
+{
+	if( !is_std_stream( file_name ) ) {
+		file = std::fopen( file_name.c_str(), "r" );
+
+		if( !file ) {
+			throw STDERR_EXCEPTION( Tools::format( "cannot open file %s", file_name ) );
+		}
+
+		close_file = true;
+	}
+}
+
+TextSampleReader::~TextSampleReader()
+{
+	if( close_file ) {
+		std::fclose( file );
+	}
+}
+
+void TextSampleReader::fill()
+{
+	std::memmove( buffer.data(), buffer.data() + begin, end - begin );
+	end -= begin;
+	begin = 0;
+
+	// a single token longer than the buffer
+	if( end == buffer.size() ) {
+		buffer.resize( buffer.size() * 2 );
+	}
+
+	const std::size_t len = std::fread( buffer.data() + end, 1, buffer.size() - end, file );
+
+	if( len == 0 ) {
+		if( std::ferror( file ) ) {
+			throw STDERR_EXCEPTION( "reading samples failed" );
+		}
+		eof = true;
+	}
+
+	end += len;
+}
+
+std::size_t TextSampleReader::read( std::span<double> samples )
+{
+	std::size_t count = 0;
+
+	while( count < samples.size() ) {
+
+		while( begin < end && is_space( buffer[begin] ) ) {
+			++begin;
+		}
+
+		std::size_t token_end = begin;
+
+		while( token_end < end && !is_space( buffer[token_end] ) ) {
+			++token_end;
+		}
+
+		// the token may continue in the next chunk
+		if( token_end == end && !eof ) {
+			fill();
+			continue;
+		}
+
+		if( begin == token_end ) {
+			// end of input, trailing whitespace produces no sample
+			break;
+		}
+
+		const char * first = buffer.data() + begin;
+		const char * last = buffer.data() + token_end;
+
+		// std::from_chars() does not accept a leading plus sign
+		if( *first == '+' ) {
+			++first;
+		}
+
+		float f_in = 0;
+		const auto res = std::from_chars( first, last, f_in );
+
+		if( res.ec != std::errc() || res.ptr != last ) {
+			throw STDERR_EXCEPTION( Tools::format( "invalid sample '%s'",
+					std::string( buffer.data() + begin, buffer.data() + token_end ) ) );
+		}
+
+		samples[count++] = f_in;
+		begin = token_end;
+	}
+
+	return count;
+}
+
+TextSampleWriter::TextSampleWriter( const std::string & file_name )
+: file( nullptr ),
+  close_file( false ),
+  buffer( WRITE_BUFFER_SIZE )
+{
+	file = open_output( file_name, false, close_file );
+}
+
+TextSampleWriter::~TextSampleWriter()
+{
+	try {
+		flush();
+	} catch( const std::exception & error ) {
+		std::cerr << "Error: " << error.what() << std::endl;
+	}
+
+	if( close_file ) {
+		std::fclose( file );
+	}
+}
+
+void TextSampleWriter::write( std::span<const double> samples )
+{
+	for( double s : samples ) {
+		if( buffer_used + MAX_TEXT_SAMPLE_SIZE > buffer.size() ) {
+			flush();
+		}
+
+		char * p = buffer.data() + buffer_used;
+
+		// same as std::cout << s
+		const auto res = std::to_chars( p, buffer.data() + buffer.size(), s, std::chars_format::general, 6 );
+
+		*res.ptr = '\n';
+		buffer_used = res.ptr + 1 - buffer.data();
+	}
+}
+
+void TextSampleWriter::flush()
+{
+	const std::size_t len = buffer_used;
+	buffer_used = 0;
+
+	write_all( file, buffer.data(), len );
+}
+
+BinarySampleReader::BinarySampleReader( const std::string & file_name, SampleFormat format_ )
+: file( file_name ),
+  format( format_ ),
+  data( file.get_data() )
+{
+	SampleHeader header;
+
+	if( header.load( data, file_name ) ) {
+		format = header.format;
+		data = data.subspan( SampleHeader::SIZE );
+	}
+
+	if( sample_format_size( format ) == 0 ) {
+		throw STDERR_EXCEPTION( Tools::format( "%s: no binary sample format given", file_name ) );
+	}
+
+	// ignore a truncated last sample
+	data = data.first( data.size() - data.size() % sample_format_size( format ) );
+}
+
+std::size_t BinarySampleReader::read( std::span<double> samples )
+{
+	const std::size_t sample_size = sample_format_size( format );
+	const std::size_t count = std::min( samples.size(), ( data.size() - pos ) / sample_size );
+	const unsigned char * p = data.data() + pos;
+
+	switch( format ) {
+	case SampleFormat::int16:
+		for( std::size_t i = 0; i < count; ++i ) {
+			samples[i] = load_le<int16_t>( p + i * sample_size );
+		}
+		break;
+
+	case SampleFormat::int32:
+		for( std::size_t i = 0; i < count; ++i ) {
+			samples[i] = load_le<int32_t>( p + i * sample_size );
+		}
+		break;
+
+	case SampleFormat::float32:
+		for( std::size_t i = 0; i < count; ++i ) {
+			samples[i] = load_le<float>( p + i * sample_size );
+		}
+		break;
+
+	case SampleFormat::float64:
+		for( std::size_t i = 0; i < count; ++i ) {
+			samples[i] = load_le<double>( p + i * sample_size );
+		}
+		break;
+
+	case SampleFormat::text:
+		return 0;
+	}
+
+	pos += count * sample_size;
+
+	return count;
+}
+
+BinarySampleWriter::BinarySampleWriter( const std::string & file_name, SampleFormat format_, bool write_header )
+: file( nullptr ),
+  close_file( false ),
+  format( format_ ),
+  buffer( WRITE_BUFFER_SIZE )
+{
+	if( sample_format_size( format ) == 0 ) {
+		throw STDERR_EXCEPTION( "no binary sample format given" );
+	}
+
+	file = open_output( file_name, true, close_file );
+
+	if( write_header ) {
+		SampleHeader header;
+		header.format = format;
+		header.store( buffer.data() );
+		buffer_used = SampleHeader::SIZE;
+	}
+}
+
+BinarySampleWriter::~BinarySampleWriter()
+{
+	try {
+		flush();
+	} catch( const std::exception & error ) {
+		std::cerr << "Error: " << error.what() << std::endl;
+	}
+
+	if( close_file ) {
+		std::fclose( file );
+	}
+}
+
+void BinarySampleWriter::write( std::span<const double> samples )
+{
+	const std::size_t sample_size = sample_format_size( format );
+
+	for( double s : samples ) {
+		if( buffer_used + sample_size > buffer.size() ) {
+			flush();
+		}
+
+		unsigned char * p = buffer.data() + buffer_used;
+
+		switch( format ) {
+		case SampleFormat::int16:   store_le<int16_t>( p, to_integer<int16_t>( s ) ); break;
+		case SampleFormat::int32:   store_le<int32_t>( p, to_integer<int32_t>( s ) ); break;
+		case SampleFormat::float32: store_le<float>( p, static_cast<float>( s ) ); break;
+		case SampleFormat::float64: store_le<double>( p, s ); break;
+		case SampleFormat::text:    break;
+		}
+
+		buffer_used += sample_size;
+	}
+}
+
+void BinarySampleWriter::flush()
+{
+	const std::size_t len = buffer_used;
+	buffer_used = 0;
+
+	write_all( file, buffer.data(), len );
+}
@@ -0,0 +1,215 @@
+/*
+ * SampleIO.h
+ *
+ * Sample readers and writers for test_fir.
+ *
+ * Binary files contain raw little endian samples, optionally preceded
+ * by a SampleHeader. Input files are memory mapped, so even captures
+ * of several GB are read at memory bandwidth.
+ *
+ * Text files contain one number per token, separated by whitespace.
+ * They are read and written in large chunks and converted with
+ * std::from_chars and std::to_chars, no locale is involved.
+ *
+ * The file name "-" means stdin or stdout.
+ */
+
+#ifndef TEST_FIR_SAMPLE_IO_H
+#define TEST_FIR_SAMPLE_IO_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+enum class SampleFormat : uint16_t
+{
+	text   = 0,
+	int16  = 1,
+	int32  = 2,
+	float32 = 3,
+	float64 = 4
+};
+
+/**
+ * "int16", "int32", "float", "double" or "text",
+ * throws an exception for anything else
+ */
+SampleFormat parse_sample_format( const std::string & name );
+
+const char * sample_format_name( SampleFormat format );
+
+/**
+ * size of one sample in bytes, 0 for text
+ */
+std::size_t sample_format_size( SampleFormat format );
+
+/**
+ * Optional header of a binary sample file, 8 bytes, little endian:
+ * the magic, the version and the sample format, 16 bit each.
+ * If a file starts with the magic, the format in the header is used.
+ */
+struct SampleHeader
+{
+	static constexpr char MAGIC[4] = { 'S', 'M', 'P', 'L' };
+	static constexpr uint16_t VERSION = 1;
+	static constexpr std::size_t SIZE = 8;
+
+	uint16_t version = VERSION;
+	SampleFormat format = SampleFormat::text;
+
+	/**
+	 * Returns false if data does not start with the magic. Throws an
+	 * exception for another version or a format that is no binary one.
+	 */
+	bool load( std::span<const unsigned char> data, const std::string & file_name );
+
+	/**
+	 * writes SIZE bytes, throws an exception if the header is not valid
+	 */
+	void store( unsigned char * data ) const;
+};
+
+/**
+ * Read only view of a whole file. Uses mmap, on WIN32
+ * and for stdin the data is read into memory instead.
+ */
+class MappedFile
+{
+	const unsigned char * data = nullptr;
+	std::size_t size = 0;
+	std::vector<unsigned char> buffer;
+
+public:
+	explicit MappedFile( const std::string & file_name );
+	~MappedFile();
+
+	MappedFile( const MappedFile & other ) = delete;
+	MappedFile & operator=( const MappedFile & other ) = delete;
+
+	std::span<const unsigned char> get_data() const {
+		return { data, size };
+	}
+};
+
+class SampleReader
+{
+public:
+	virtual ~SampleReader() {}
+
+	/**
+	 * fills samples from the beginning, returns the number of
+	 * samples read. 0 means end of input.
+	 */
+	virtual std::size_t read( std::span<double> samples ) = 0;
+};
+
+class SampleWriter
+{
+public:
+	virtual ~SampleWriter() {}
+
+	virtual void write( std::span<const double> samples ) = 0;
+
+	virtual void flush() {}
+};
+
+class TextSampleReader : public SampleReader
+{
+	std::FILE * file;
+	bool close_file;
+	std::vector<char> buffer;
+	std::size_t begin = 0;      // first unparsed character in buffer
+	std::size_t end = 0;        // end of valid data in buffer
+	bool eof = false;
+
+public:
+	explicit TextSampleReader( const std::string & file_name );
+	~TextSampleReader();
+
+	TextSampleReader( const TextSampleReader & other ) = delete;
+	TextSampleReader & operator=( const TextSampleReader & other ) = delete;
+
+	std::size_t read( std::span<double> samples ) override;
+
+private:
+	/**
+	 * moves the unparsed rest to the front and appends the next chunk
+	 */
+	void fill();
+};
+
+/**
+ * Writes one value per line, formatted like printf( "%g" ).
+ */
+class TextSampleWriter : public SampleWriter
+{
+	std::FILE * file;
+	bool close_file;
+	std::vector<char> buffer;
+	std::size_t buffer_used = 0;
+
+public:
+	/**
+	 * an empty file name or "-" writes to stdout
+	 */
+	explicit TextSampleWriter( const std::string & file_name = std::string() );
+	~TextSampleWriter();
+
+	TextSampleWriter( const TextSampleWriter & other ) = delete;
+	TextSampleWriter & operator=( const TextSampleWriter & other ) = delete;
+
+	void write( std::span<const double> samples ) override;
+
+	void flush() override;
+};
+
+class BinarySampleReader : public SampleReader
+{
+	MappedFile file;
+	SampleFormat format;
+	std::span<const unsigned char> data;
+	std::size_t pos = 0;
+
+public:
+	/**
+	 * format is used if the file has no header
+	 */
+	BinarySampleReader( const std::string & file_name, SampleFormat format );
+
+	SampleFormat get_format() const {
+		return format;
+	}
+
+	std::size_t read( std::span<double> samples ) override;
+};
+
+/**
+ * Integer formats are rounded and clipped to the range of the type.
+ */
+class BinarySampleWriter : public SampleWriter
+{
+	std::FILE * file;
+	bool close_file;
+	SampleFormat format;
+	std::vector<unsigned char> buffer;
+	std::size_t buffer_used = 0;
+
+public:
+	/**
+	 * an empty file name or "-" writes to stdout
+	 */
+	BinarySampleWriter( const std::string & file_name, SampleFormat format, bool write_header );
+	~BinarySampleWriter();
+
+	BinarySampleWriter( const BinarySampleWriter & other ) = delete;
+	BinarySampleWriter & operator=( const BinarySampleWriter & other ) = delete;
+
+	void write( std::span<const double> samples ) override;
+
+	void flush() override;
+};
+
+#endif  /* TEST_FIR_SAMPLE_IO_H */
@@ -7,10 +7,31 @@
 #include <stderr_exception.h>
 #include <fstream>
 #include "SNRDFir.hpp"
+#include "SNRDDynamic.hpp"
+#include "SNRDNormalized.hpp"
+#include "SNRDCompensated.hpp"
+#include "SNRDTruncated.hpp"
+#include "SNRDParallel.hpp"
+#include "FFTConvolution.hpp"
+#include "SampleIO.h"
+#include "CheckEngines.h"
+#include "CheckSampleIO.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 using namespace Tools;
 using namespace exmath;
 
+/*
+ * Configurations no option uses, instantiated completely,
+ * so every member of them has to compile.
+ */
+template class Filter::SNRDFir::Filter<float,float,13*2+1,Filter::SNRDFir::internal::InstanceCoefficients<float,13*2+1>>;
+template class Filter::SNRDFir::Filter<double,double,7*2+1,Filter::SNRDFir::internal::InstanceCoefficients<double,7*2+1>>;
+template class Filter::SNRDFir::NormalizedFilter<float,float,13*2+1>;
+template class Filter::SNRDFir::NormalizedFilter<double,double,7*2+1>;
+
 template<class T>
 static void dump_array( const T & co )
 {
@@ -49,6 +70,92 @@ static float get_12bit_adc_as_volt( int32_t adc_value )
 	return volt;
 }
 
+/**
+ * Filters all samples of reader in blocks and passes the results to writer.
+ * in_conv converts a sample to the filter input, out_conv a filter result
+ * back to the written value.
+ *
+ * With more than one thread every block is split into chunks that are
+ * filtered in parallel. The direct-form engines give bit-identical output
+ * at any thread count. A BlockFilter with the FFT engine cuts its blocks
+ * at other places then, so the output differs by the FFT rounding, at
+ * most 4 epsilon times the largest input magnitude, the tolerance the
+ * engine checks allow against the direct form.
+ *
+ * Blocks and chunks are at least as long as a BlockFilter needs
+ * to use the FFT engine.
+ */
+template<class FILTER, class IN_CONV, class OUT_CONV>
+static void run_filter( const FILTER & filter, unsigned threads,
+						SampleReader & reader, SampleWriter & writer,
+						IN_CONV in_conv, OUT_CONV out_conv )
+{
+	typedef decltype( in_conv( 0.0 ) ) T;
+	typedef Filter::SNRDFir::ParallelFilter<FILTER> PARALLEL_FILTER;
+
+	std::size_t min_block_size = 0;
+
+	if constexpr( requires { filter.get_fft_min_block_size(); } ) {
+		min_block_size = filter.get_fft_min_block_size();
+	}
+
+	const std::size_t chunk_size = min_block_size
+			? std::max( min_block_size, PARALLEL_FILTER::default_chunk_size( Filter::SNRDFir::internal::taps_of( filter ) ) )
+			: 0;
+
+	PARALLEL_FILTER parallel_filter( threads, chunk_size, filter );
+
+	// a block has to provide a chunk for every thread
+	const std::size_t BLOCK_SIZE = parallel_filter.get_threads() > 1
+			? parallel_filter.get_threads() * parallel_filter.get_chunk_size()
+			: std::max<std::size_t>( 4096, min_block_size );
+
+	std::vector<double> samples( BLOCK_SIZE );
+	std::vector<T> in( BLOCK_SIZE );
+	std::vector<T> out( BLOCK_SIZE );
+
+	while( std::size_t count = reader.read( samples ) ) {
+
+		for( std::size_t i = 0; i < count; ++i ) {
+			in[i] = in_conv( samples[i] );
+		}
+
+		parallel_filter.process( std::span<const T>( in.data(), count ), std::span<T>( out.data(), count ) );
+
+		for( std::size_t i = 0; i < count; ++i ) {
+			samples[i] = out_conv( out[i] );
+		}
+
+		writer.write( std::span<const double>( samples.data(), count ) );
+	}
+
+	writer.flush();
+}
+
+template<class T>
+static T identity( T value )
+{
+	return value;
+}
+
+/**
+ * --fft-min-block sets the smallest block for the FFT engine of a
+ * BlockFilter, --fft-calibrate measures it. Without them the fixed
+ * default stays, so the output is the same on every machine.
+ */
+template<class BLOCK_FILTER>
+static void configure_fft( BLOCK_FILTER & filter, Arg::IntOption & o_fft_min_block, Arg::FlagOption & o_fft_calibrate )
+{
+	if( o_fft_min_block.isSet() ) {
+		if( o_fft_min_block.getValues()->at(0) < 0 ) {
+			throw STDERR_EXCEPTION( "--fft-min-block must not be negative" );
+		}
+		filter.set_fft_min_block_size( o_fft_min_block.getValues()->at(0) );
+	} else if( o_fft_calibrate.getState() ) {
+		filter.calibrate();
+	}
+}
+
 
 int main( int argc, char **argv )
 {
@@ -69,6 +176,18 @@ int main( int argc, char **argv )
 		o_help.setDescription( "Show this page" );
 		oc_info.addOptionR( &o_help );
 
+		Arg::FlagOption o_check_kernels( "check-kernels" );
+		o_check_kernels.setDescription( "Check all SIMD kernels supported by this CPU against the scalar code" );
+		oc_info.addOptionR( &o_check_kernels );
+
+		Arg::FlagOption o_check_engines( "check-engines" );
+		o_check_engines.setDescription( "Check the results of all filter engines against Filter, single and block wise" );
+		oc_info.addOptionR( &o_check_engines );
+
+		Arg::FlagOption o_check_io( "check-io" );
+		o_check_io.setDescription( "Check that the sample readers read back what the writers wrote, from files and stdin" );
+		oc_info.addOptionR( &o_check_io );
+
 		Arg::FlagOption o_debug("d");
 		o_debug.addName( "debug" );
 		o_debug.setDescription("print debugging messages");
@@ -95,9 +214,72 @@ int main( int argc, char **argv )
 		o_fir4.setRequired(false);
 		arg.addOptionR( &o_fir4 );
 
+		Arg::FlagOption o_fir5("fir5");
+		o_fir5.setDescription("FIR filter with float 795 cofficients and compensated summation. "
+							  "Scaled like --fir3.");
+		o_fir5.setRequired(false);
+		arg.addOptionR( &o_fir5 );
+
+		Arg::FlagOption o_fir6("fir6");
+		o_fir6.setDescription("FIR filter with double 795 cofficients, the outer ones dropped "
+							  "as far as 16 bit ADC values allow for an output error of 1e-6. Scaled like --fir3.");
+		o_fir6.setRequired(false);
+		arg.addOptionR( &o_fir6 );
+
+
+		Arg::FlagOption o_fft("fft");
+		o_fft.setDescription("--fir3 and --taps use the FFT engine for long blocks, by default for blocks "
+							 "of 8 FFT sizes from 255 taps on");
+		o_fft.setRequired(false);
+		arg.addOptionR( &o_fft );
+
+		Arg::IntOption o_fft_min_block("fft-min-block");
+		o_fft_min_block.setDescription("with --fft blocks from this size on use the FFT engine, 0 never");
+		o_fft_min_block.setRequired(false);
+		arg.addOptionR( &o_fft_min_block );
+
+		Arg::FlagOption o_fft_calibrate("fft-calibrate");
+		o_fft_calibrate.setDescription("with --fft measure the block size the FFT engine gets faster from. "
+									   "The output then depends on the machine.");
+		o_fft_calibrate.setRequired(false);
+		arg.addOptionR( &o_fft_calibrate );
+
+		Arg::IntOption o_taps("taps");
+		o_taps.setDescription("FIR filter with double and this number of cofficients, chosen at runtime. "
+							  "Scaled like --fir3, --taps 795 is the same filter.");
+		o_taps.setRequired(false);
+		arg.addOptionR( &o_taps );
+
+		Arg::StringOption o_in_format("in-format");
+		o_in_format.setDescription("format of the input file: text (default), int16, int32, float or double. "
+								   "Binary files are memory mapped.");
+		o_in_format.setRequired(false);
+		arg.addOptionR( &o_in_format );
+
+		Arg::StringOption o_out_format("out-format");
+		o_out_format.setDescription("format of the output: text (default), int16, int32, float or double");
+		o_out_format.setRequired(false);
+		arg.addOptionR( &o_out_format );
+
+		Arg::StringOption o_out("out");
+		o_out.setDescription("write the output to this file instead of stdout, - is stdout");
+		o_out.setRequired(false);
+		arg.addOptionR( &o_out );
+
+		Arg::FlagOption o_header("header");
+		o_header.setDescription("write a sample header in front of the binary output");
+		o_header.setRequired(false);
+		arg.addOptionR( &o_header );
+
+		Arg::IntOption o_threads("threads");
+		o_threads.setDescription("number of threads, 0 uses all cores, default 1. The output is bit-identical "
+								 "to one thread, except with --fft, where it may differ by 4 epsilon times "
+								 "the largest input magnitude");
+		o_threads.setRequired(false);
+		arg.addOptionR( &o_threads );
 
 		Arg::EmptyFileOption o_file;
-		o_file.setDescription("input file");
+		o_file.setDescription("input file, - reads from stdin");
 		o_file.setRequired(true);
 		arg.addOptionR( &o_file );
 
@@ -117,111 +299,179 @@ int main( int argc, char **argv )
 			return 1;
 		}
 
-		if( o_fir1.getState() ) {
+		if( o_check_kernels.getState() ) {
+			using namespace Filter::simd;
 
-			std::ifstream in( o_file.getValues()->at(0) );
+			std::cout << "detected instruction set: " << isa_name( detect_isa() ) << std::endl;
 
-			if( !in ) {
-				throw STDERR_EXCEPTION( Tools::format( "cannot open file %s", o_file.getValues()->at(0) ) );
-			}
+			bool ok = true;
 
-			Filter::SNRDFir::Filter<int64_t,int64_t,27*2+1> filter;
-			filter.set_default_denominator(filter.get_default_denominator()/ 256);
+			for( unsigned i = 0; i <= static_cast<unsigned>(detect_isa()); ++i ) {
+				const ISA isa = static_cast<ISA>(i);
+				const bool isa_ok = verify_kernels( isa );
 
-			//constexpr auto c = filter.check_will_it_overflow( 1 );
-			/*
-			if( filter.check_will_overflow(1) ) {
-				throw std::out_of_range( "value to large" );
-			}*/
+				std::cout << isa_name( isa ) << ": " << ( isa_ok ? "OK" : "FAILED" ) << std::endl;
 
-			//dump_coefficients(filter);
+				ok = ok && isa_ok;
+			}
 
-			while( !in.eof() ) {
+			return ok ? 0 : 1;
+		}
 
-				float f_in = 0;
-				in >> f_in;
+		if( o_check_engines.getState() ) {
+			return check_engines( std::cout ) ? 0 : 1;
+		}
 
-				uint32_t adc = get_as_12bit_adc( f_in );
-				//std::cout << adc << std::endl;
+		if( o_check_io.getState() ) {
+			return check_sample_io( std::cout ) ? 0 : 1;
+		}
 
-				// std::cout << filter(adc) << std::endl;
+		const std::string & file_name = o_file.getValues()->at(0);
 
-				filter(adc);
-				int64_t filtered_adc = filter.get_result();
+		SampleFormat in_format = SampleFormat::text;
+		SampleFormat out_format = SampleFormat::text;
+		std::string out_file;
 
-				std::cout << get_12bit_adc_as_volt(filtered_adc) << std::endl;
-				//std::cout << filtered_adc << std::endl;
-			}
+		if( o_in_format.isSet() ) {
+			in_format = parse_sample_format( o_in_format.getValues()->at(0) );
+		}
+
+		if( o_out_format.isSet() ) {
+			out_format = parse_sample_format( o_out_format.getValues()->at(0) );
+		}
+
+		if( o_out.isSet() ) {
+			out_file = o_out.getValues()->at(0);
 		}
-		else if( o_fir2.getState() ) {
 
-			std::ifstream in( o_file.getValues()->at(0) );
+		unsigned threads = 1;
 
-			if( !in ) {
-				throw STDERR_EXCEPTION( Tools::format( "cannot open file %s", o_file.getValues()->at(0) ) );
+		if( o_threads.isSet() ) {
+			if( o_threads.getValues()->at(0) < 0 ) {
+				throw STDERR_EXCEPTION( "--threads must not be negative" );
 			}
+			threads = o_threads.getValues()->at(0);
+		}
 
-			Filter::SNRDFir::Filter<float,float,63*2+1> filter;
-			filter.set_default_denominator(filter.get_default_denominator()/ 256.0);
-			//dump_coefficients(filter);
+		std::unique_ptr<SampleReader> reader;
+		std::unique_ptr<SampleWriter> writer;
 
-			while( !in.eof() ) {
+		if( in_format == SampleFormat::text ) {
+			reader = std::make_unique<TextSampleReader>( file_name );
+		} else {
+			reader = std::make_unique<BinarySampleReader>( file_name, in_format );
+		}
 
-				float f_in = 0;
-				in >> f_in;
+		if( out_format == SampleFormat::text ) {
+			writer = std::make_unique<TextSampleWriter>( out_file );
+		} else {
+			writer = std::make_unique<BinarySampleWriter>( out_file, out_format, o_header.getState() );
+		}
 
-				filter(f_in);
+		if( o_fir1.getState() ) {
 
-				std::cout << filter.get_result() << std::endl;
-			}
+			Filter::SNRDFir::Filter<int64_t,int64_t,27*2+1> filter;
+			filter.set_default_denominator(filter.get_default_denominator()/ 256);
 
-		}
-		else if( o_fir3.getState() ) {
+			//constexpr auto c = filter.check_will_it_overflow( 1 );
+			/*
+			if( filter.check_will_overflow(1) ) {
+				throw std::out_of_range( "value to large" );
+			}*/
 
-			std::ifstream in( o_file.getValues()->at(0) );
+			//dump_coefficients(filter);
 
-			if( !in ) {
-				throw STDERR_EXCEPTION( Tools::format( "cannot open file %s", o_file.getValues()->at(0) ) );
-			}
+			run_filter( filter, threads, *reader, *writer,
+						[]( double f_in ) -> int64_t {
+							uint32_t adc = get_as_12bit_adc( f_in );
+							return adc;
+						},
+						[]( int64_t filtered_adc ) -> double {
+							return get_12bit_adc_as_volt(filtered_adc);
+						} );
+		}
+		else if( o_fir2.getState() ) {
 
-			Filter::SNRDFir::Filter<double,double,397*2+1> filter;
+			Filter::SNRDFir::Filter<float,float,63*2+1> filter;
 			filter.set_default_denominator(filter.get_default_denominator()/ 256.0);
 			//dump_coefficients(filter);
 
-			while( !in.eof() ) {
+			run_filter( filter, threads, *reader, *writer,
+						[]( double f_in ) -> float { return f_in; },
+						identity<float> );
+		}
+		else if( o_fir3.getState() && o_fft.getState() ) {
 
-				float f_in = 0;
-				in >> f_in;
+			Filter::SNRDFir::BlockFilter<double,double,397*2+1> filter;
+			filter.set_default_denominator(filter.get_default_denominator()/ 256.0);
+			configure_fft( filter, o_fft_min_block, o_fft_calibrate );
 
-				filter(f_in);
+			run_filter( filter, threads, *reader, *writer,
+						identity<double>,
+						identity<double> );
+		}
+		else if( o_fir3.getState() ) {
 
-				std::cout << filter.get_result() << std::endl;
-			}
+			Filter::SNRDFir::Filter<double,double,397*2+1> filter;
+			filter.set_default_denominator(filter.get_default_denominator()/ 256.0);
+			//dump_coefficients(filter);
 
+			run_filter( filter, threads, *reader, *writer,
+						identity<double>,
+						identity<double> );
 		}
 		else if( o_fir4.getState() ) {
 
-			std::ifstream in( o_file.getValues()->at(0) );
-
-			if( !in ) {
-				throw STDERR_EXCEPTION( Tools::format( "cannot open file %s", o_file.getValues()->at(0) ) );
-			}
-
 			Filter::SNRDFir::Filter<float,float,27*2+1> filter;
 			filter.set_default_denominator(filter.get_default_denominator()/ 256.0);
 			constexpr auto c = filter.check_will_it_overflow( 0xFFFF );
 
+			run_filter( filter, threads, *reader, *writer,
+						[]( double f_in ) -> float { return f_in; },
+						identity<float> );
+		}
+		else if( o_fir5.getState() ) {
 
-			while( !in.eof() ) {
+			// normalized taps, so the scale replaces the / 256.0 of --fir3
+			Filter::SNRDFir::CompensatedFilter<float,float,397*2+1> filter( 256 );
 
-				float f_in = 0;
-				in >> f_in;
+			run_filter( filter, threads, *reader, *writer,
+						[]( double f_in ) -> float { return f_in; },
+						identity<float> );
+		}
+		else if( o_fir6.getState() ) {
 
-				filter(f_in);
+			// the tolerance applies before the output scale
+			constexpr double output_scale = 256;
+			constexpr unsigned M = Filter::SNRDFir::truncated_taps<double,397*2+1>( 0xFFFF, 1e-6 / output_scale );
+			Filter::SNRDFir::TruncatedFilter<double,double,397*2+1,M> filter( output_scale );
 
-				std::cout << filter.get_result() << std::endl;
+			run_filter( filter, threads, *reader, *writer,
+						identity<double>,
+						identity<double> );
+		}
+		else if( o_taps.isSet() ) {
+
+			if( o_taps.getValues()->at(0) < 3 || o_taps.getValues()->at(0) % 2 == 0 ) {
+				throw STDERR_EXCEPTION( "--taps has to be odd and at least 3" );
 			}
 
+			if( o_fft.getState() ) {
+				Filter::SNRDFir::DynamicBlockFilter<double,double> filter( o_taps.getValues()->at(0) );
+				filter.set_default_denominator(filter.get_default_denominator()/ 256.0);
+				configure_fft( filter, o_fft_min_block, o_fft_calibrate );
+
+				run_filter( filter, threads, *reader, *writer,
+							identity<double>,
+							identity<double> );
+			} else {
+				Filter::SNRDFir::DynamicFilter<double,double> filter( o_taps.getValues()->at(0) );
+				filter.set_default_denominator(filter.get_default_denominator()/ 256.0);
+
+				run_filter( filter, threads, *reader, *writer,
+							identity<double>,
+							identity<double> );
+			}
 		}
 
 	} catch( const std::exception & error ) {